@@ -0,0 +1,253 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstring>
+
+#include "clipstore.h"
+
+
+class ClipStorePrivate {
+public:
+    ClipStorePrivate(void)
+        : compressed(false)
+        , compressNext(false)
+        , complete(false)
+        , bytes(0)
+        , uncompressedBytes(0)
+        , maxLookupUs(0)
+    { /* ... */ }
+    struct Entry {
+        qint64 pts;
+        int number;
+        VideoFrame::ColorRange colorRange;
+        VideoFrame::ColorMatrix colorMatrix;
+        QSize size;
+        VideoFrame frame;
+        QByteArray packed;
+    };
+    mutable QMutex mtx;
+    QVector<Entry> entries;
+    bool compressed;
+    bool compressNext;
+    bool complete;
+    qint64 bytes;
+    qint64 uncompressedBytes;
+    mutable qint64 maxLookupUs;
+
+    // Writes all planes without padding, every line as differences to its left neighbour.
+    static QByteArray pack(const VideoFrame &frame)
+    {
+        int total = 0;
+        for (int p = 0; p < frame.planeCount(); ++p) {
+            const QSize &sz = frame.planeSize(p);
+            total += sz.width() * sz.height();
+        }
+        QByteArray packed(total, Qt::Uninitialized);
+        uchar *dst = reinterpret_cast<uchar *>(packed.data());
+        for (int p = 0; p < frame.planeCount(); ++p) {
+            const QSize &sz = frame.planeSize(p);
+            for (int y = 0; y < sz.height(); ++y) {
+                const uchar *src = frame.bits(p) + y * frame.bytesPerLine(p);
+                uchar prev = 0;
+                for (int x = 0; x < sz.width(); ++x) {
+                    *dst++ = uchar(src[x] - prev);
+                    prev = src[x];
+                }
+            }
+        }
+        return packed;
+    }
+    static void unpack(const QByteArray &packed, VideoFrame &frame)
+    {
+        const uchar *src = reinterpret_cast<const uchar *>(packed.constData());
+        for (int p = 0; p < frame.planeCount(); ++p) {
+            const QSize &sz = frame.planeSize(p);
+            for (int y = 0; y < sz.height(); ++y) {
+                uchar *dst = frame.bits(p) + y * frame.bytesPerLine(p);
+                uchar prev = 0;
+                for (int x = 0; x < sz.width(); ++x) {
+                    prev = uchar(prev + *src++);
+                    dst[x] = prev;
+                }
+            }
+        }
+    }
+};
+
+
+ClipStore::ClipStore(void)
+    : d_ptr(new ClipStorePrivate)
+{
+    // ...
+}
+
+
+ClipStore::~ClipStore()
+{
+    // ...
+}
+
+
+void ClipStore::setCompressed(bool compressed)
+{
+    Q_D(ClipStore);
+    QMutexLocker locker(&d->mtx);
+    d->compressNext = compressed;
+}
+
+
+bool ClipStore::isCompressed(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->compressed;
+}
+
+
+void ClipStore::clear(void)
+{
+    Q_D(ClipStore);
+    QMutexLocker locker(&d->mtx);
+    d->entries.clear();
+    d->compressed = d->compressNext;
+    d->complete = false;
+    d->bytes = 0;
+    d->uncompressedBytes = 0;
+    d->maxLookupUs = 0;
+}
+
+
+void ClipStore::append(const VideoFrame &frame)
+{
+    Q_D(ClipStore);
+    if (frame.pixelFormat() != VideoFrame::Format_YUV420P) {
+        qWarning() << "ClipStore: only YUV420P frames can be stored.";
+        return;
+    }
+    ClipStorePrivate::Entry entry;
+    entry.pts = frame.pts;
+    entry.number = frame.number;
+    entry.colorRange = frame.colorRange;
+    entry.colorMatrix = frame.colorMatrix;
+    entry.size = frame.size();
+    d->mtx.lock();
+    const bool compressed = d->compressed;
+    d->mtx.unlock();
+    qint64 bytes;
+    if (compressed) {
+        entry.packed = qCompress(ClipStorePrivate::pack(frame), 1);
+        bytes = entry.packed.size();
+    }
+    else {
+        // a private copy, so the decoder's buffers aren't held for the lifetime of the store
+        entry.frame = VideoFrame(frame.size(), frame.pixelFormat());
+        for (int p = 0; p < frame.planeCount(); ++p) {
+            const QSize &sz = frame.planeSize(p);
+            for (int y = 0; y < sz.height(); ++y)
+                memcpy(entry.frame.bits(p) + y * entry.frame.bytesPerLine(p), frame.bits(p) + y * frame.bytesPerLine(p), size_t(sz.width()));
+        }
+        entry.frame.pts = frame.pts;
+        entry.frame.number = frame.number;
+        entry.frame.colorRange = frame.colorRange;
+        entry.frame.colorMatrix = frame.colorMatrix;
+        bytes = VideoFrame::bufferSize(frame.size());
+    }
+    QMutexLocker locker(&d->mtx);
+    d->entries.append(entry);
+    d->bytes += bytes;
+    d->uncompressedBytes += VideoFrame::bufferSize(frame.size());
+}
+
+
+void ClipStore::setComplete(void)
+{
+    Q_D(ClipStore);
+    QMutexLocker locker(&d->mtx);
+    d->complete = true;
+}
+
+
+bool ClipStore::isComplete(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->complete;
+}
+
+
+int ClipStore::count(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->entries.count();
+}
+
+
+int ClipStore::indexOf(qint64 ms) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    const QVector<ClipStorePrivate::Entry> &entries = d_ptr->entries;
+    QVector<ClipStorePrivate::Entry>::const_iterator it = std::upper_bound(entries.constBegin(), entries.constEnd(), ms,
+                                                                         [](qint64 value, const ClipStorePrivate::Entry &entry) {
+        return value < entry.pts;
+    });
+    return qMax(0, int(it - entries.constBegin()) - 1);
+}
+
+
+qint64 ClipStore::pts(int index) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->entries.at(index).pts;
+}
+
+
+VideoFrame ClipStore::frame(int index, FramePool *pool) const
+{
+    QElapsedTimer lookupTimer;
+    lookupTimer.start();
+    d_ptr->mtx.lock();
+    const ClipStorePrivate::Entry entry = d_ptr->entries.at(index);
+    d_ptr->mtx.unlock();
+    VideoFrame videoFrame = entry.frame;
+    if (!entry.packed.isEmpty()) {
+        videoFrame = VideoFrame(entry.size, VideoFrame::Format_YUV420P, pool);
+        ClipStorePrivate::unpack(qUncompress(entry.packed), videoFrame);
+        videoFrame.pts = entry.pts;
+        videoFrame.number = entry.number;
+        videoFrame.colorRange = entry.colorRange;
+        videoFrame.colorMatrix = entry.colorMatrix;
+    }
+    const qint64 us = lookupTimer.nsecsElapsed() / 1000;
+    QMutexLocker locker(&d_ptr->mtx);
+    d_ptr->maxLookupUs = qMax(d_ptr->maxLookupUs, us);
+    return videoFrame;
+}
+
+
+// Memory occupied by the frames.
+qint64 ClipStore::bytes(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->bytes;
+}
+
+
+qint64 ClipStore::uncompressedBytes(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->uncompressedBytes;
+}
+
+
+// Longest time frame() took to look up and, if need be, decompress a
+// frame since the last clear(). Queueing and presentation aren't included.
+qint64 ClipStore::maxLookupUs(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->maxLookupUs;
+}
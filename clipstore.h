@@ -0,0 +1,52 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __CLIPSTORE_H_
+#define __CLIPSTORE_H_
+
+#include <QScopedPointer>
+
+#include "videoframe.h"
+#include "framepool.h"
+
+
+class ClipStorePrivate;
+
+// Holds every frame of a short clip in memory as YUV420P so that it can
+// be played without touching the decoder or the disk. Frames are either
+// kept as they are or, to save memory, compressed losslessly: each line
+// is replaced by the differences between neighbouring pixels, which
+// deflate then packs at its fastest level.
+class ClipStore
+{
+public:
+    ClipStore(void);
+    ~ClipStore();
+
+    // Takes effect with the next clear().
+    void setCompressed(bool compressed);
+    bool isCompressed(void) const;
+    void clear(void);
+    // Frames must be appended in presentation order.
+    void append(const VideoFrame &frame);
+    void setComplete(void);
+    bool isComplete(void) const;
+    int count(void) const;
+    // Index of the frame on screen at `ms`.
+    int indexOf(qint64 ms) const;
+    qint64 pts(int index) const;
+    // Decompressed frames are written into buffers taken from `pool`.
+    VideoFrame frame(int index, FramePool *pool) const;
+
+    qint64 bytes(void) const;
+    qint64 uncompressedBytes(void) const;
+    qint64 maxLookupUs(void) const;
+
+private:
+    QScopedPointer<ClipStorePrivate> d_ptr;
+    Q_DECLARE_PRIVATE(ClipStore)
+    Q_DISABLE_COPY(ClipStore)
+
+};
+
+#endif // __CLIPSTORE_H_
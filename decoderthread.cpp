@@ -1,205 +1,1641 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#include <QtCore/QDebug>
-
-#include "decoderthread.h"
-#include "util.h"
-#include "semaphores.h"
-
-extern "C" {
-#include <libavutil/imgutils.h>
-#include <libavutil/samplefmt.h>
-#include <libavutil/opt.h>
-#include <libavutil/pixdesc.h>
-#include <libavformat/avformat.h>
-#include <libswscale/swscale.h>
-#include <libavcodec/avcodec.h>
-#include <libavfilter/buffersink.h>
-#include <libavfilter/buffersrc.h>
-}
-
-class DecoderThreadPrivate {
-public:
-    explicit DecoderThreadPrivate(void)
-        : doAbort(false)
-        , fmtCtx(nullptr)
-        , videoDecCtx(nullptr)
-        , videoEncCtx(nullptr)
-        , videoEncBitrate(0)
-        , w(0)
-        , h(0)
-        , videoStreamIdx(-1)
-        , videoStream(nullptr)
-        , imgConvertCtx(nullptr)
-        , videoDstBufsize(0)
-        , videoFrameCount(0)
-        , frame(av_frame_alloc())
-        , frameRGB(av_frame_alloc())
-        , frameEnc(av_frame_alloc())
-        , frameBuffer(nullptr)
-    {
-        memset(videoDstData, 0, 4 * sizeof(uint8_t *));
-        memset(videoDstLinesize, 0, 4 * sizeof(int));
-    }
-    bool doAbort;
-    AVFormatContext *fmtCtx;
-    AVCodecContext *videoDecCtx;
-    AVCodecContext *videoEncCtx;
-    int videoEncBitrate;
-    int w;
-    int h;
-    int videoStreamIdx;
-    AVStream *videoStream;
-    SwsContext *imgConvertCtx;
-    int videoDstBufsize;
-    int videoFrameCount;
-    AVFrame *frame;
-    AVFrame *frameRGB;
-    AVFrame *frameEnc;
-    uint8_t *frameBuffer;
-    AVPacket pkt;
-    AVPacket encPkt;
-    uint8_t *videoDstData[4];
-    int videoDstLinesize[4];
-    int rc;
-
-    virtual ~DecoderThreadPrivate() {
-        av_frame_free(&frame);
-        av_frame_free(&frameRGB);
-        av_freep(&videoDstData[0]);
-    }
-};
-
-
-DecoderThread::DecoderThread(QObject *parent)
-    : QThread(parent)
-    , d_ptr(new DecoderThreadPrivate)
-{
-    av_register_all();
-    qDebug() << "AVCodec version:" << avformat_version();
-    qDebug() << "AVFormat configuration:" << avformat_configuration();
-}
-
-
-bool DecoderThread::openVideo(const QString &filename)
-{
-    Q_D(DecoderThread);
-    const std::string &filename_str = filename.toStdString();
-    const char *src_filename = filename_str.c_str();
-    d->rc = avformat_open_input(&d->fmtCtx, src_filename, nullptr, nullptr);
-    if (d->rc < 0)
-        return false;
-    emit durationChanged(1000 * d->fmtCtx->duration / AV_TIME_BASE);
-    d->rc = avformat_find_stream_info(d->fmtCtx, nullptr);
-    if (d->rc < 0)
-        return false;
-    d->rc = av_find_best_stream(d->fmtCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
-    if (d->rc < 0)
-        return false;
-    d->videoStreamIdx = d->rc;
-    d->videoStream = d->fmtCtx->streams[d->videoStreamIdx];
-    if (!d->videoStream)
-        return false;
-    d->videoDecCtx = d->videoStream->codec;
-    AVStream *st = d->fmtCtx->streams[d->videoStreamIdx];
-    AVCodecContext *dec_ctx = st->codec;
-    AVCodec *dec = avcodec_find_decoder(dec_ctx->codec_id);
-    if (!dec)
-        return false;
-    AVDictionary *opts = nullptr;
-    av_dict_set(&opts, "refcounted_frames", "1", 0);
-    d->rc = avcodec_open2(dec_ctx, dec, &opts);
-    if (d->rc < 0)
-        return false;
-    d->w = d->videoDecCtx->width;
-    d->h = d->videoDecCtx->height;
-    d->videoDstBufsize = av_image_alloc(
-                d->videoDstData, d->videoDstLinesize,
-                d->w, d->h, d->videoDecCtx->pix_fmt, 1);
-    av_dump_format(d->fmtCtx, 0, src_filename, 0);
-    const int numBytes = avpicture_get_size(AV_PIX_FMT_ARGB, d->w, d->h);
-    d->frameBuffer = new uint8_t[numBytes];
-    avpicture_fill((AVPicture *)d->frameRGB, d->frameBuffer, AV_PIX_FMT_RGB24, d->w, d->h);
-    return true;
-}
-
-
-void DecoderThread::abort(void)
-{
-    Q_D(DecoderThread);
-    d->doAbort = true;
-    // terminate();
-    wait(5*1000);
-}
-
-
-void DecoderThread::run(void)
-{
-    Q_D(DecoderThread);
-    d->doAbort = false;
-    av_init_packet(&d->pkt);
-    d->pkt.data = nullptr;
-    d->pkt.size = 0;
-    d->rc = 0;
-    int gotFrame = 0;
-    while (!d->doAbort) {
-        AVPacket origPkt = d->pkt;
-        d->rc = av_read_frame(d->fmtCtx, &d->pkt);
-        if (d->rc < 0)
-            break;
-        do {
-            int ret = decodePacket(gotFrame);
-            if (ret < 0)
-                break;
-            d->pkt.data += ret;
-            d->pkt.size -= ret;
-        } while (d->pkt.size > 0);
-        av_free_packet(&origPkt);
-    }
-    qDebug().nospace() << "DecoderThread " << (d->doAbort ? "canceled" : "finished decoding uncached frames") << ".";
-    if (!d->doAbort) {
-        d->pkt.data = nullptr;
-        d->pkt.size = 0;
-        do  {
-            decodePacket(gotFrame);
-        } while (gotFrame && !d->doAbort);
-    }
-    qDebug() << "DecoderThread ending ...";
-}
-
-
-int DecoderThread::decodePacket(int &gotFrame)
-{
-    Q_D(DecoderThread);
-    static const AVRational ms = {1, 1000};
-    int ret = 0;
-    int decoded = d->pkt.size;
-    gotFrame = 0;
-    ret = avcodec_decode_video2(d->videoDecCtx, d->frame, &gotFrame, &d->pkt);
-    if (ret < 0)
-        return ret;
-    if (gotFrame) {
-        qint64 t = av_rescale_q(d->pkt.pts, d->fmtCtx->streams[d->pkt.stream_index]->time_base, ms);
-        emit positionChanged(t);
-        d->imgConvertCtx = sws_getCachedContext(d->imgConvertCtx, d->w, d->h, d->videoDecCtx->pix_fmt, d->w, d->h, AV_PIX_FMT_BGRA, SWS_BICUBIC, nullptr, nullptr, nullptr);
-        if (d->imgConvertCtx == nullptr) {
-            qFatal("Cannot initialize the conversion context!");
-            return -1;
-        }
-        sws_scale(d->imgConvertCtx, d->frame->data, d->frame->linesize, 0, d->h, d->frameRGB->data, d->frameRGB->linesize);
-        QImage img(d->w, d->h, QImage::Format_ARGB32);
-        for (int y = 0; y < d->h; ++y) {
-            uint8_t *const dst  = img.scanLine(y);
-            if (!dst)
-                qFatal("Out of memory error.");
-            const uint8_t *src = d->frameRGB->data[0] + y * d->frameRGB->linesize[0];
-            memcpy(dst, src, 4 * d->w);
-        }
-        av_frame_unref(d->frame);
-        gFramesProduced.acquire();
-        emit frameReady(img, d->videoFrameCount);
-        ++d->videoFrameCount;
-    }
-    return decoded;
-}
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QMap>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QQueue>
+#include <QWaitCondition>
+#include <algorithm>
+
+#include "decoderthread.h"
+#include "demuxerthread.h"
+#include "util.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/samplefmt.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+#include <libavcodec/avcodec.h>
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+}
+
+// Drops the reference to a decoded frame's buffers when the last
+// VideoFrame referring to them goes away.
+class AVFrameReleaser {
+public:
+    AVFrameReleaser(AVFrame *frame, const QSharedPointer<QAtomicInt> &pinned)
+        : frame(frame)
+        , pinned(pinned)
+    { /* ... */ }
+    void operator()(FrameBuffer *buf)
+    {
+        av_frame_free(&frame);
+        pinned->deref();
+        delete buf;
+    }
+private:
+    AVFrame *frame;
+    QSharedPointer<QAtomicInt> pinned;
+};
+
+
+class DecoderThreadPrivate {
+public:
+    explicit DecoderThreadPrivate(void)
+        : doAbort(false)
+        , fmtCtx(nullptr)
+        , videoDecCtx(nullptr)
+        , videoEncCtx(nullptr)
+        , videoEncBitrate(0)
+        , w(0)
+        , h(0)
+        , videoStreamIdx(-1)
+        , videoStream(nullptr)
+        , imgConvertCtx(nullptr)
+        , videoDstBufsize(0)
+        , videoFrameCount(0)
+        , frame(av_frame_alloc())
+        , frameEnc(av_frame_alloc())
+        , pinnedFrames(new QAtomicInt(0))
+        , demuxer(new DemuxerThread(&packetQueue))
+        , frameQueue(DecoderThread::DefaultQueueDepth)
+        , framePool(DecoderThread::DefaultQueueDepth + 2)
+        , threadCount(0)
+        , threadType(DecoderThread::FrameThreading)
+        , busyNs(0)
+        , fpsFrameCount(0)
+        , decodeFps(0)
+        , frameDurationMs(0)
+        , paused(false)
+        , framesToStep(0)
+        , lastPts(0)
+        , seekTargetMs(-1)
+        , seekPending(false)
+        , prefetchFrames(DecoderThread::DefaultPrefetchFrames)
+        , direction(+1)
+        , firstFrame(false)
+        , restartPending(false)
+        , flipPending(false)
+        , reverse(false)
+        , adaptiveDropping(true)
+        , discardLevel(DecoderThread::DiscardNothing)
+        , framesAtLevel(0)
+        , calmFrames(0)
+        , clock(&ownClock)
+        , lastDecodedPts(-1)
+        , lastFrameTime(-1)
+        , droppedFrameCount(0)
+        , recordFramePts(false)
+        , inputMode(MediaInput::Auto)
+        , preloadEnabled(false)
+        , preloadMaxMs(DecoderThread::DefaultPreloadMaxMs)
+        , preloadMaxBytes(Q_INT64_C(1024) * 1024 * DecoderThread::DefaultPreloadMaxMB)
+        , preloadCompressed(false)
+        , preloadClip(false)
+        , preloading(false)
+        , preloadOverBudget(false)
+        , speedDiscardLevel(DecoderThread::DiscardNothing)
+        , discardFloor(DecoderThread::DiscardNothing)
+        , throughputSpeed(1.0)
+        , throughputFrames(0)
+        , throughputStartPts(0)
+        , convertFrames(0)
+        , convertNs(0)
+        , convertBytes(0)
+    {
+        memset(videoDstData, 0, 4 * sizeof(uint8_t *));
+        memset(videoDstLinesize, 0, 4 * sizeof(int));
+    }
+    bool doAbort;
+    AVFormatContext *fmtCtx;
+    AVCodecContext *videoDecCtx;
+    AVCodecContext *videoEncCtx;
+    int videoEncBitrate;
+    int w;
+    int h;
+    int videoStreamIdx;
+    AVStream *videoStream;
+    SwsContext *imgConvertCtx;
+    int videoDstBufsize;
+    int videoFrameCount;
+    AVFrame *frame;
+    AVFrame *frameEnc;
+    // decoded frames handed out without a copy, see convertFrame()
+    QSharedPointer<QAtomicInt> pinnedFrames;
+    static const int MaxPinnedFrames = 8;
+    PacketQueue packetQueue;
+    DemuxerThread *demuxer;
+    FrameQueue frameQueue;
+    // frames waiting in the queue plus the one being decoded and the one being displayed
+    FramePool framePool;
+    int threadCount; // 0 = as many as there are cores
+    DecoderThread::ThreadType threadType;
+    QElapsedTimer fpsTimer;
+    qint64 busyNs;
+    int fpsFrameCount;
+    qreal decodeFps;
+    KeyframeIndex keyframeIndex;
+    qint64 frameDurationMs;
+    QMutex pauseMutex;
+    QWaitCondition pauseCond;
+    bool paused;
+    int framesToStep;
+    qint64 lastPts;
+    // frames before `seekTargetMs` are decoded but neither converted nor delivered
+    qint64 seekTargetMs;
+    bool seekPending;
+    QElapsedTimer seekTimer;
+    FrameCache frameCache;
+    // number of frames converted into the cache in the playback direction beyond the one on screen
+    int prefetchFrames;
+    int direction;
+    // frames decoded but not yet handed over to the frame queue
+    QQueue<VideoFrame> ahead;
+    // the first frame after (re)starting is delivered even while paused
+    bool firstFrame;
+    // the decoder was stopped because a seek was served from the cache
+    bool restartPending;
+    // set by setSpeed() when the playback direction changes while decoding, see run()
+    bool flipPending;
+    // the direction this decoder plays in; a clock shared with other decoders can't tell
+    // which of them have turned around already
+    bool reverse;
+    // frame found in the cache on a seek, to be delivered by the decoder thread, the frame queue's only producer
+    VideoFrame cachedFrame;
+    // requested frame sizes by consumer name, an invalid size means full resolution
+    QMap<QString, QSize> consumerSizes;
+    QSize outputSize;
+    mutable QMutex sizeMutex;
+    bool adaptiveDropping;
+    int discardLevel;
+    int framesAtLevel;
+    int calmFrames;
+    // drives presentation, frames are late if their pts has passed on this clock
+    PresentationClock ownClock;
+    // `ownClock` unless the decoder shares a clock with others
+    PresentationClock *clock;
+    qint64 lastDecodedPts;
+    // time of the frame decoded last, -1 after the decoder has been flushed
+    qint64 lastFrameTime;
+    QAtomicInt droppedFrameCount;
+    // frames this late are dropped before conversion
+    static const int LateFrames = 1;
+    // escalate the discard level if frames are this late ...
+    static const int EscalateLateFrames = 3;
+    // ... but give the current level this many frames to show an effect first
+    static const int SettleFrames = 12;
+    // step down again after this many frames delivered in time
+    static const int CalmFrames = 50;
+    QString filename;
+    // guards `mediaIndex`, which is remapped when the decoder rewrites the sidecar
+    mutable QMutex indexMutex;
+    MediaIndex mediaIndex;
+    MediaIndex::StreamInfo streamInfo;
+    MediaInput input;
+    MediaInput::Mode inputMode;
+    // clips no longer than `preloadMaxMs` are decoded into `clipStore` completely and then played from there,
+    // unless they take up more than `preloadMaxBytes`
+    ClipStore clipStore;
+    bool preloadEnabled;
+    qint64 preloadMaxMs;
+    qint64 preloadMaxBytes;
+    bool preloadCompressed;
+    bool preloadClip;
+    bool preloading;
+    bool preloadOverBudget;
+    QElapsedTimer preloadTimer;
+    // discard level the playback speed calls for, adaptive dropping only ever goes beyond it
+    int speedDiscardLevel;
+    // the level decoding is held at, `speedDiscardLevel` while playing and DiscardNothing while paused
+    int discardFloor;
+    // sustained throughput, measured in windows of a second
+    struct Throughput {
+        qint64 frames;
+        qint64 wallMs;
+        qint64 mediaMs;
+    };
+    QMap<qreal, Throughput> throughput;
+    QElapsedTimer throughputTimer;
+    qreal throughputSpeed;
+    int throughputFrames;
+    qint64 throughputStartPts;
+    // cost of converting frames at the current output size
+    QSize convertSize;
+    int convertFrames;
+    qint64 convertNs;
+    qint64 convertBytes;
+    // from this rate on only keyframes are decoded unless the decoder is fast enough anyway
+    static const int KeyframesOnlySpeed = 4;
+    QVector<qint64> framePts;
+    bool recordFramePts;
+    AVPacket pkt;
+    AVPacket encPkt;
+    uint8_t *videoDstData[4];
+    int videoDstLinesize[4];
+    int rc;
+
+    // Scales the stream's size down as far as all consumers allow, keeping
+    // the aspect ratio and even dimensions. Returns true if the size changed.
+    bool updateOutputSize(void)
+    {
+        qreal scale = consumerSizes.isEmpty() ? 1.0 : 0.0;
+        foreach (const QSize &size, consumerSizes) {
+            if (!size.isValid() || w == 0 || h == 0) {
+                scale = 1.0;
+                break;
+            }
+            scale = qMax(scale, qMax(qreal(size.width()) / w, qreal(size.height()) / h));
+        }
+        scale = qMin(scale, qreal(1.0));
+        const QSize size(qMax(2, qRound(scale * w / 2) * 2), qMax(2, qRound(scale * h / 2) * 2));
+        if (size == outputSize)
+            return false;
+        outputSize = size;
+        qDebug() << "DecoderThread: output size" << outputSize;
+        return true;
+    }
+    // Frames at rates above 1x are only decoded in full if the decoder has
+    // proven to be fast enough for it. Otherwise non-reference frames are
+    // skipped and, at higher rates, everything but keyframes.
+    int discardLevelForSpeed(qreal speed) const
+    {
+        const qreal rate = qAbs(speed);
+        if (rate <= 1.0)
+            return DecoderThread::DiscardNothing;
+        const qreal fps = frameDurationMs > 0 ? 1000.0 / frameDurationMs : 25.0;
+        if (decodeFps > 1.25 * rate * fps)
+            return DecoderThread::DiscardNothing;
+        return rate < KeyframesOnlySpeed ? DecoderThread::SkipNonRefFrames : DecoderThread::SkipNonKeyFrames;
+    }
+    // Presentation time of the frame just decoded in ms. A frame without a
+    // timestamp is taken to follow the previous one by a frame duration.
+    qint64 frameTime(void)
+    {
+        static const AVRational ms = {1, 1000};
+        int64_t ts = av_frame_get_best_effort_timestamp(frame);
+        if (ts == AV_NOPTS_VALUE && lastFrameTime < 0)
+            ts = frame->pkt_dts;
+        if (ts != AV_NOPTS_VALUE)
+            lastFrameTime = av_rescale_q(ts, videoStream->time_base, ms);
+        else
+            lastFrameTime = (lastFrameTime < 0) ? 0 : lastFrameTime + qMax(Q_INT64_C(1), frameDurationMs);
+        return lastFrameTime;
+    }
+    // Largest lowres factor the codec supports that still decodes at least at output size.
+    int lowresFor(const AVCodec *dec) const
+    {
+        int lowres = 0;
+        if (dec == nullptr)
+            return lowres;
+        while (lowres < dec->max_lowres
+               && (w >> (lowres + 1)) >= outputSize.width()
+               && (h >> (lowres + 1)) >= outputSize.height())
+            ++lowres;
+        return lowres;
+    }
+
+    virtual ~DecoderThreadPrivate() {
+        delete demuxer;
+        av_frame_free(&frame);
+        av_frame_free(&frameEnc);
+        av_freep(&videoDstData[0]);
+    }
+};
+
+
+DecoderThread::DecoderThread(QObject *parent)
+    : QThread(parent)
+    , d_ptr(new DecoderThreadPrivate)
+{
+    qRegisterMetaType<VideoFrame>("VideoFrame");
+    av_register_all();
+    qDebug() << "AVCodec version:" << avformat_version();
+    qDebug() << "AVFormat configuration:" << avformat_configuration();
+}
+
+
+bool DecoderThread::openVideo(const QString &filename)
+{
+    Q_D(DecoderThread);
+    const std::string &filename_str = filename.toStdString();
+    const char *src_filename = filename_str.c_str();
+    closeVideo();
+    if (!d->input.open(filename, d->inputMode))
+        return false;
+    d->fmtCtx = avformat_alloc_context();
+    d->fmtCtx->pb = d->input.ioContext();
+    d->rc = avformat_open_input(&d->fmtCtx, src_filename, nullptr, nullptr);
+    if (d->rc < 0)
+        return false;
+    d->filename = filename;
+    // a valid sidecar index saves probing the stream, which can take seconds
+    bool haveIndex = d->mediaIndex.load(filename);
+    if (haveIndex) {
+        const MediaIndex::StreamInfo &si = d->mediaIndex.streamInfo();
+        haveIndex = si.streamIndex >= 0
+                && si.streamIndex < int(d->fmtCtx->nb_streams)
+                && d->fmtCtx->streams[si.streamIndex]->codec->codec_type == AVMEDIA_TYPE_VIDEO;
+        if (haveIndex) {
+            d->videoStreamIdx = si.streamIndex;
+            AVStream *st = d->fmtCtx->streams[si.streamIndex];
+            AVCodecContext *c = st->codec;
+            c->codec_id = AVCodecID(si.codecId);
+            c->width = si.width;
+            c->height = si.height;
+            c->pix_fmt = AVPixelFormat(si.pixelFormat);
+            if (c->extradata == nullptr && !si.extradata.isEmpty()) {
+                c->extradata = reinterpret_cast<uint8_t *>(av_mallocz(si.extradata.size() + FF_INPUT_BUFFER_PADDING_SIZE));
+                memcpy(c->extradata, si.extradata.constData(), si.extradata.size());
+                c->extradata_size = si.extradata.size();
+            }
+            st->avg_frame_rate.num = si.frameRateNum;
+            st->avg_frame_rate.den = si.frameRateDen;
+        }
+        else {
+            d->mediaIndex.unload();
+        }
+    }
+    if (!haveIndex) {
+        d->rc = avformat_find_stream_info(d->fmtCtx, nullptr);
+        if (d->rc < 0)
+            return false;
+        d->rc = av_find_best_stream(d->fmtCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (d->rc < 0)
+            return false;
+        d->videoStreamIdx = d->rc;
+    }
+    d->videoStream = d->fmtCtx->streams[d->videoStreamIdx];
+    if (!d->videoStream)
+        return false;
+    const qint64 durationMs = haveIndex
+            ? d->mediaIndex.streamInfo().durationMs
+            : (d->fmtCtx->duration != AV_NOPTS_VALUE ? 1000 * d->fmtCtx->duration / AV_TIME_BASE : 0);
+    emit durationChanged(durationMs);
+    d->clipStore.setCompressed(d->preloadCompressed);
+    d->clipStore.clear();
+    d->videoDecCtx = d->videoStream->codec;
+    AVCodecContext *dec_ctx = d->videoDecCtx;
+    d->sizeMutex.lock();
+    // read before openCodec(), so this is the full size even if lowres is used;
+    // lowresFor() and reopening the codec for another output size depend on that
+    d->w = dec_ctx->width;
+    d->h = dec_ctx->height;
+    d->updateOutputSize();
+    d->sizeMutex.unlock();
+    if (!openCodec())
+        return false;
+    d->videoDstBufsize = av_image_alloc(
+                d->videoDstData, d->videoDstLinesize,
+                d->w, d->h, d->videoDecCtx->pix_fmt, 1);
+    av_dump_format(d->fmtCtx, 0, src_filename, 0);
+    const AVRational frameRate = d->videoStream->avg_frame_rate;
+    d->packetQueue.setTimeBase(d->videoStream->time_base,
+                               frameRate.num > 0 ? av_rescale_q(1, av_inv_q(frameRate), d->videoStream->time_base) : 0);
+    d->frameDurationMs = frameRate.num > 0 ? qint64(1000 * av_q2d(av_inv_q(frameRate))) : 0;
+    d->preloadClip = d->preloadEnabled && durationMs > 0 && durationMs <= d->preloadMaxMs;
+    if (d->preloadClip && !d->preloadCompressed && d->frameDurationMs > 0) {
+        // uncompressed the size is known beforehand, compressed clips are checked while preloading
+        const qint64 expectedBytes = (durationMs / d->frameDurationMs + 1) * VideoFrame::bufferSize(outputSize());
+        d->preloadClip = expectedBytes <= d->preloadMaxBytes;
+        if (!d->preloadClip)
+            qDebug() << "DecoderThread: clip needs about" << expectedBytes / 1024 / 1024 << "MB, not preloading it.";
+    }
+    // seed the keyframe index with what the sidecar or the container already know, the demuxer fills in the rest while playing
+    d->keyframeIndex.clear();
+    if (haveIndex && d->mediaIndex.keyframeCount() > 0) {
+        const MediaIndex::KeyframeEntry *keyframes = d->mediaIndex.keyframes();
+        for (qint64 i = 0; i < d->mediaIndex.keyframeCount(); ++i)
+            d->keyframeIndex.add(keyframes[i].pts, keyframes[i].pos);
+    }
+    else {
+        for (int i = 0; i < d->videoStream->nb_index_entries; ++i) {
+            const AVIndexEntry &entry = d->videoStream->index_entries[i];
+            if (entry.flags & AVINDEX_KEYFRAME)
+                d->keyframeIndex.add(entry.timestamp, entry.pos);
+        }
+    }
+    qDebug() << "Keyframe index holds" << d->keyframeIndex.count() << "entries after opening.";
+    d->streamInfo = MediaIndex::StreamInfo();
+    d->streamInfo.streamIndex = d->videoStreamIdx;
+    d->streamInfo.codecId = dec_ctx->codec_id;
+    d->streamInfo.width = d->w;
+    d->streamInfo.height = d->h;
+    d->streamInfo.pixelFormat = dec_ctx->pix_fmt;
+    d->streamInfo.timeBaseNum = d->videoStream->time_base.num;
+    d->streamInfo.timeBaseDen = d->videoStream->time_base.den;
+    d->streamInfo.frameRateNum = frameRate.num;
+    d->streamInfo.frameRateDen = frameRate.den;
+    d->streamInfo.durationMs = durationMs;
+    d->streamInfo.startPts = d->videoStream->start_time != AV_NOPTS_VALUE ? d->videoStream->start_time : 0;
+    if (dec_ctx->extradata != nullptr)
+        d->streamInfo.extradata = QByteArray(reinterpret_cast<const char *>(dec_ctx->extradata), dec_ctx->extradata_size);
+    if (!haveIndex)
+        MediaIndex::save(filename, d->streamInfo, QVector<qint64>(), d->keyframeIndex.entries());
+    // record the timestamps of all frames during the first complete run so they can go into the sidecar
+    d->framePts.clear();
+    d->recordFramePts = !haveIndex || d->mediaIndex.frameCount() == 0;
+    d->demuxer->setSource(d->fmtCtx, d->videoStreamIdx);
+    d->demuxer->setKeyframeIndex(&d->keyframeIndex);
+    d->demuxer->setFramePtsRecorder(d->recordFramePts ? &d->framePts : nullptr);
+    d->seekTargetMs = -1;
+    d->seekPending = false;
+    d->restartPending = false;
+    d->lastPts = 0;
+    d->clock->invalidate();
+    d->frameCache.clear();
+    d->droppedFrameCount.store(0);
+    d->throughput.clear();
+    // filled only now that the output size is known, with buffers of that size
+    d->framePool.reserve(VideoFrame::bufferSize(outputSize()));
+    return true;
+}
+
+
+// (Re)opens the decoder with the lowres factor matching the current output size.
+bool DecoderThread::openCodec(void)
+{
+    Q_D(DecoderThread);
+    AVCodecContext *dec_ctx = d->videoDecCtx;
+    AVCodec *dec = avcodec_find_decoder(dec_ctx->codec_id);
+    if (!dec)
+        return false;
+    if (avcodec_is_open(dec_ctx)) {
+        avcodec_close(dec_ctx);
+        dec_ctx->width = d->w;
+        dec_ctx->height = d->h;
+    }
+    AVDictionary *opts = nullptr;
+    av_dict_set(&opts, "refcounted_frames", "1", 0);
+    dec_ctx->thread_count = (d->threadCount > 0) ? d->threadCount : QThread::idealThreadCount();
+    dec_ctx->thread_type = (d->threadType == SliceThreading) ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+    d->sizeMutex.lock();
+    dec_ctx->lowres = d->lowresFor(dec);
+    d->sizeMutex.unlock();
+    d->rc = avcodec_open2(dec_ctx, dec, &opts);
+    av_dict_free(&opts);
+    if (d->rc < 0)
+        return false;
+    qDebug() << "Decoding with" << dec_ctx->thread_count << "threads,"
+             << ((dec_ctx->active_thread_type & FF_THREAD_FRAME) ? "frame" : (dec_ctx->active_thread_type & FF_THREAD_SLICE) ? "slice" : "no")
+             << "threading active, lowres" << dec_ctx->lowres;
+    return true;
+}
+
+
+// Lets a consumer tell the decoder which size it needs the frames in. An
+// invalid size stands for full resolution. The decoder delivers the
+// smallest size that satisfies all consumers, decoding at reduced
+// resolution if the codec supports it and scaling down otherwise.
+void DecoderThread::setConsumerResolution(const QString &consumer, const QSize &size)
+{
+    Q_D(DecoderThread);
+    d->sizeMutex.lock();
+    d->consumerSizes[consumer] = size;
+    d->sizeMutex.unlock();
+    outputSizeChanged();
+}
+
+
+void DecoderThread::removeConsumer(const QString &consumer)
+{
+    Q_D(DecoderThread);
+    d->sizeMutex.lock();
+    d->consumerSizes.remove(consumer);
+    d->sizeMutex.unlock();
+    outputSizeChanged();
+}
+
+
+// Frames of the new size are scaled from then on. If the lowres factor has
+// to change as well, decoding restarts at the current position.
+void DecoderThread::outputSizeChanged(void)
+{
+    Q_D(DecoderThread);
+    d->sizeMutex.lock();
+    const bool changed = d->updateOutputSize();
+    const bool reopen = d->videoDecCtx != nullptr
+            && d->lowresFor(avcodec_find_decoder(d->videoDecCtx->codec_id)) != d->videoDecCtx->lowres;
+    d->sizeMutex.unlock();
+    if (!changed)
+        return;
+    d->frameCache.clear();
+    if (reopen && isRunning())
+        seek(position());
+}
+
+
+// Size of the frames handed over to the frame queue.
+QSize DecoderThread::outputSize(void) const
+{
+    QMutexLocker locker(&d_ptr->sizeMutex);
+    return d_ptr->outputSize;
+}
+
+
+// Size of the video as stored, before any scaling for the consumers.
+QSize DecoderThread::videoSize(void) const
+{
+    QMutexLocker locker(&d_ptr->sizeMutex);
+    return QSize(d_ptr->w, d_ptr->h);
+}
+
+
+// Local files are memory-mapped by default. ReadAhead suits slow or
+// network-mounted volumes. Takes effect with the next openVideo().
+void DecoderThread::setInputMode(MediaInput::Mode mode, int readAheadWindow)
+{
+    Q_D(DecoderThread);
+    d->inputMode = mode;
+    d->input.setReadAheadWindow(readAheadWindow);
+}
+
+
+MediaInput::Mode DecoderThread::inputMode(void) const
+{
+    return d_ptr->inputMode;
+}
+
+
+const MediaInput *DecoderThread::mediaInput(void) const
+{
+    return &d_ptr->input;
+}
+
+
+// Short clips are decoded completely into memory before playback starts,
+// optionally compressed losslessly. Afterwards playback, seeking and
+// stepping neither decode nor read from disk. A clip that would occupy
+// more than `maxBytes` is played from disk as usual. Takes effect with the
+// next openVideo().
+void DecoderThread::setPreload(bool enabled, qint64 maxDurationMs, bool compressed, qint64 maxBytes)
+{
+    Q_D(DecoderThread);
+    d->preloadEnabled = enabled;
+    d->preloadMaxMs = maxDurationMs;
+    d->preloadCompressed = compressed;
+    d->preloadMaxBytes = maxBytes;
+}
+
+
+bool DecoderThread::preloadEnabled(void) const
+{
+    return d_ptr->preloadEnabled;
+}
+
+
+qint64 DecoderThread::preloadMaxDuration(void) const
+{
+    return d_ptr->preloadMaxMs;
+}
+
+
+qint64 DecoderThread::preloadMaxBytes(void) const
+{
+    return d_ptr->preloadMaxBytes;
+}
+
+
+bool DecoderThread::preloadCompressed(void) const
+{
+    return d_ptr->preloadCompressed;
+}
+
+
+const ClipStore *DecoderThread::clipStore(void) const
+{
+    return &d_ptr->clipStore;
+}
+
+
+void DecoderThread::closeVideo(void)
+{
+    Q_D(DecoderThread);
+    if (d->videoDecCtx != nullptr) {
+        avcodec_close(d->videoDecCtx);
+        d->videoDecCtx = nullptr;
+    }
+    if (d->fmtCtx != nullptr)
+        avformat_close_input(&d->fmtCtx);
+    if (d->input.isOpen()) {
+        qDebug() << "MediaInput: bytes read:" << d->input.bytesRead()
+                 << "stalls:" << d->input.stalls()
+                 << "seeks:" << d->input.seeks()
+                 << "seek distance:" << d->input.seekDistance() / 1024 << "KB";
+        d->input.close();
+    }
+    av_freep(&d->videoDstData[0]);
+    d->indexMutex.lock();
+    d->mediaIndex.unload();
+    d->indexMutex.unlock();
+    d->clipStore.clear();
+    d->preloadClip = false;
+    d->videoStream = nullptr;
+    d->videoStreamIdx = -1;
+    d->videoFrameCount = 0;
+}
+
+
+void DecoderThread::abort(void)
+{
+    Q_D(DecoderThread);
+    d->doAbort = true;
+    d->packetQueue.cancel();
+    d->frameQueue.cancel();
+    d->pauseMutex.lock();
+    d->flipPending = false;
+    d->pauseCond.wakeAll();
+    d->pauseMutex.unlock();
+    wait(5*1000);
+    d->demuxer->abort();
+    // the recorded frame timestamps won't be complete any more
+    d->recordFramePts = false;
+    d->demuxer->setFramePtsRecorder(nullptr);
+    d->frameQueue.clear();
+    d->cachedFrame = VideoFrame();
+}
+
+
+// Must not be called while the thread is running.
+void DecoderThread::setQueueDepth(int depth)
+{
+    Q_D(DecoderThread);
+    Q_ASSERT(!isRunning());
+    d->frameQueue.setCapacity(depth);
+    d->framePool.setCapacity(depth + 2);
+}
+
+
+// A count of 0 means one thread per core. Takes effect with the next call to openVideo().
+void DecoderThread::setDecoderThreads(int count, ThreadType type)
+{
+    Q_D(DecoderThread);
+    d->threadCount = count;
+    d->threadType = type;
+}
+
+
+int DecoderThread::decoderThreadCount(void) const
+{
+    return d_ptr->threadCount;
+}
+
+
+DecoderThread::ThreadType DecoderThread::decoderThreadType(void) const
+{
+    return d_ptr->threadType;
+}
+
+
+// Frames per second the decoder manages while it's busy, i.e. not counting
+// the time it waits for room in the frame queue.
+qreal DecoderThread::decodeFps(void) const
+{
+    return d_ptr->decodeFps;
+}
+
+
+// Limits the amount of compressed data the demuxer may read ahead of the decoder.
+// Must not be called while the thread is running.
+void DecoderThread::setPacketQueueLimits(int maxBytes, int maxDurationMs, qreal lowWatermark)
+{
+    Q_D(DecoderThread);
+    Q_ASSERT(!isRunning());
+    d->packetQueue.setLimits(maxBytes, maxDurationMs, lowWatermark);
+}
+
+
+const PacketQueue *DecoderThread::packetQueue(void) const
+{
+    return &d_ptr->packetQueue;
+}
+
+
+const KeyframeIndex *DecoderThread::keyframeIndex(void) const
+{
+    return &d_ptr->keyframeIndex;
+}
+
+
+// Limits the memory converted frames may occupy in the cache.
+void DecoderThread::setFrameCacheBudget(qint64 bytes)
+{
+    d_ptr->frameCache.setBudget(bytes);
+}
+
+
+const FrameCache *DecoderThread::frameCache(void) const
+{
+    return &d_ptr->frameCache;
+}
+
+
+// Sets how many frames beyond the current one are converted into the cache
+// while paused, ahead when stepping forward and behind when stepping backward.
+void DecoderThread::setPrefetchFrames(int n)
+{
+    Q_D(DecoderThread);
+    QMutexLocker locker(&d->pauseMutex);
+    d->prefetchFrames = qMax(0, n);
+}
+
+
+int DecoderThread::prefetchFrames(void) const
+{
+    QMutexLocker locker(&d_ptr->pauseMutex);
+    return d_ptr->prefetchFrames;
+}
+
+
+// With adaptive dropping the decoder watches how far behind the presentation
+// clock it is during playback. Late frames are dropped without being converted
+// and, if that doesn't suffice, the codec is told to skip decoding
+// non-reference or even all non-key frames. Every dropped frame is
+// reported via frameDropped().
+void DecoderThread::setAdaptiveDropping(bool enabled)
+{
+    Q_D(DecoderThread);
+    QMutexLocker locker(&d->pauseMutex);
+    d->adaptiveDropping = enabled;
+}
+
+
+bool DecoderThread::adaptiveDropping(void) const
+{
+    QMutexLocker locker(&d_ptr->pauseMutex);
+    return d_ptr->adaptiveDropping;
+}
+
+
+int DecoderThread::droppedFrameCount(void) const
+{
+    return d_ptr->droppedFrameCount.load();
+}
+
+
+// Frames are to be presented when this clock reaches their timestamp.
+// The decoder pauses it, invalidates it on seeks and measures against it
+// how late it is.
+PresentationClock *DecoderThread::presentationClock(void)
+{
+    return d_ptr->clock;
+}
+
+
+// Makes the decoder follow `clock` instead of its own, so that several
+// decoders present in sync. Passing nullptr reverts to the own clock.
+// Must not be called while the thread is running.
+void DecoderThread::setPresentationClock(PresentationClock *clock)
+{
+    Q_D(DecoderThread);
+    Q_ASSERT(!isRunning());
+    d->clock = (clock != nullptr) ? clock : &d->ownClock;
+    d->reverse = d->clock->speed() < 0;
+}
+
+
+qreal DecoderThread::speed(void) const
+{
+    return d_ptr->clock->speed();
+}
+
+
+// Plays back `speed` times as fast as normal, backwards if `speed` is
+// negative. Changing direction restarts decoding at the current position.
+// Otherwise the frames already decoded ahead or queued are kept: they were
+// decoded under the old discard level and are presented against the clock,
+// which runs at the new rate at once, so right after speeding up a few of
+// them come late and in a burst until the decoder catches up.
+void DecoderThread::setSpeed(qreal speed)
+{
+    Q_D(DecoderThread);
+    if (qFuzzyIsNull(speed))
+        return;
+    d->clock->setSpeed(speed);
+    d->pauseMutex.lock();
+    const bool flip = (speed < 0) != d->reverse;
+    d->reverse = speed < 0;
+    d->speedDiscardLevel = d->discardLevelForSpeed(speed);
+    if (flip && isRunning()) {
+        // the decoder thread winds down and turns around by itself
+        d->flipPending = true;
+        d->doAbort = true;
+        d->pauseCond.wakeAll();
+    }
+    if (d->flipPending) {
+        // Under the lock, so this happens before run() turns around and
+        // resumes the queues. Cancelling before clearing keeps a decoder
+        // blocked in push() from slipping a stale frame in.
+        d->packetQueue.cancel();
+        d->frameQueue.cancel();
+        // frames decoded for the old direction
+        d->frameQueue.clear();
+    }
+    d->pauseMutex.unlock();
+}
+
+
+// Presentation time in milliseconds of the frame delivered last.
+qint64 DecoderThread::position(void) const
+{
+    QMutexLocker locker(&d_ptr->pauseMutex);
+    return d_ptr->lastPts;
+}
+
+
+qint64 DecoderThread::duration(void) const
+{
+    return d_ptr->streamInfo.durationMs;
+}
+
+
+qint64 DecoderThread::frameDuration(void) const
+{
+    return d_ptr->frameDurationMs;
+}
+
+
+// Number of frames from the first keyframe to the second, 0 if the keyframe index doesn't know yet.
+int DecoderThread::gopLength(void) const
+{
+    static const AVRational ms = {1, 1000};
+    if (d_ptr->videoStream == nullptr || d_ptr->frameDurationMs <= 0)
+        return 0;
+    const QVector<KeyframeIndex::Entry> &keyframes = d_ptr->keyframeIndex.entries();
+    if (keyframes.count() < 2)
+        return 0;
+    return int(av_rescale_q(keyframes.at(1).pts - keyframes.at(0).pts, d_ptr->videoStream->time_base, ms) / d_ptr->frameDurationMs);
+}
+
+
+bool DecoderThread::isPaused(void) const
+{
+    QMutexLocker locker(&d_ptr->pauseMutex);
+    return d_ptr->paused;
+}
+
+
+// While paused the decoder delivers one frame, decodes a few frames ahead
+// into the cache and then waits until it is resumed or asked to step ahead.
+void DecoderThread::setPaused(bool paused)
+{
+    Q_D(DecoderThread);
+    d->pauseMutex.lock();
+    d->paused = paused;
+    d->framesToStep = 0;
+    d->clock->setPaused(paused);
+    d->pauseCond.wakeAll();
+    const bool restart = !paused && d->restartPending;
+    const qint64 t = d->lastPts;
+    d->pauseMutex.unlock();
+    if (restart)
+        seek(t + qMax(Q_INT64_C(1), d->frameDurationMs));
+}
+
+
+// Stops the pipeline, repositions the demuxer on the last keyframe at or
+// before `ms` and restarts decoding from there. Frames before `ms` are
+// decoded but dropped before colour conversion. Emits seekCompleted()
+// once the target frame has been delivered.
+// If the target frame is in the cache it is delivered right away. While
+// paused the decoder then stays stopped until playback resumes or a frame
+// that isn't cached is requested.
+// Decoders sharing a clock leave invalidating it to the caller, so that
+// it happens once for all of them.
+void DecoderThread::seek(qint64 ms, bool invalidateClock)
+{
+    Q_D(DecoderThread);
+    static const AVRational msTimeBase = {1, 1000};
+    if (d->fmtCtx == nullptr || d->videoStream == nullptr)
+        return;
+    d->seekTimer.start();
+    // the first frame delivered after the seek sets the clock
+    if (invalidateClock)
+        d->clock->invalidate();
+    d->pauseMutex.lock();
+    d->direction = (d->reverse || ms < d->lastPts) ? -1 : +1;
+    const bool paused = d->paused;
+    const bool reverse = d->reverse;
+    d->pauseMutex.unlock();
+    abort();
+    // reverse playback does its own seeking, GOP by GOP
+    if (d->clipStore.isComplete() || reverse) {
+        d->seekTargetMs = ms;
+        d->seekPending = true;
+        d->restartPending = false;
+        start();
+        return;
+    }
+    VideoFrame cached;
+    const bool hit = d->frameCache.lookup(ms, d->frameDurationMs, cached);
+    if (hit) {
+        d->pauseMutex.lock();
+        d->cachedFrame = cached;
+        d->lastPts = cached.pts;
+        d->restartPending = paused;
+        d->pauseMutex.unlock();
+        if (paused) {
+            // the decoder thread just delivers the cached frame
+            d->seekPending = false;
+            start();
+            return;
+        }
+        // carry on decoding behind the cached frame
+        ms = cached.pts + qMax(Q_INT64_C(1), d->frameDurationMs);
+    }
+    const int64_t target = av_rescale_q(qMax(Q_INT64_C(0), ms), msTimeBase, d->videoStream->time_base);
+    const KeyframeIndex::Entry &keyframe = d->keyframeIndex.preceding(target);
+    d->rc = av_seek_frame(d->fmtCtx, d->videoStreamIdx, keyframe.isValid() ? keyframe.pts : target, AVSEEK_FLAG_BACKWARD);
+    if (d->rc < 0) {
+        qWarning() << "DecoderThread::seek(" << ms << ") failed.";
+        return;
+    }
+    d->sizeMutex.lock();
+    const int lowres = d->lowresFor(avcodec_find_decoder(d->videoDecCtx->codec_id));
+    d->sizeMutex.unlock();
+    if (lowres != d->videoDecCtx->lowres) {
+        // lowres can't be changed on an open codec
+        if (!openCodec()) {
+            qWarning() << "DecoderThread::seek(" << ms << ") failed to reopen the codec.";
+            return;
+        }
+    }
+    else {
+        avcodec_flush_buffers(d->videoDecCtx);
+    }
+    d->seekTargetMs = ms;
+    d->seekPending = !hit;
+    d->restartPending = false;
+    start();
+}
+
+
+// Steps `n` frames forward or backward. Stepping forward while paused just
+// lets the decoder deliver the next frames, which usually have been decoded
+// ahead already. Everything else is a seek, which the cache may answer.
+void DecoderThread::stepFrame(int n)
+{
+    Q_D(DecoderThread);
+    if (n == 0)
+        return;
+    d->pauseMutex.lock();
+    const bool canStepAhead = d->paused && n > 0 && isRunning() && !d->restartPending && d->direction > 0;
+    if (canStepAhead) {
+        d->direction = +1;
+        d->framesToStep += n;
+        d->pauseCond.wakeAll();
+    }
+    const qint64 t = d->lastPts;
+    d->pauseMutex.unlock();
+    if (canStepAhead)
+        return;
+    qint64 targetMs = t + n * qMax(Q_INT64_C(1), d->frameDurationMs);
+    d->indexMutex.lock();
+    const qint64 *pts = d->mediaIndex.framePts();
+    const qint64 frameCount = d->mediaIndex.frameCount();
+    if (pts != nullptr && frameCount > 0) {
+        // the sidecar knows the exact timestamp of every frame
+        static const AVRational ms = {1, 1000};
+        const AVRational tb = d->videoStream->time_base;
+        const qint64 *it = std::upper_bound(pts, pts + frameCount, t, [tb](qint64 value, qint64 framePts) {
+            return value < av_rescale_q(framePts, tb, ms);
+        });
+        const qint64 current = qMax(Q_INT64_C(0), qint64(it - pts) - 1);
+        const qint64 target = qBound(Q_INT64_C(0), current + n, frameCount - 1);
+        targetMs = av_rescale_q(pts[target], tb, ms);
+    }
+    d->indexMutex.unlock();
+    seek(targetMs);
+}
+
+
+FrameQueue *DecoderThread::frameQueue(void)
+{
+    return &d_ptr->frameQueue;
+}
+
+
+const FramePool *DecoderThread::framePool(void) const
+{
+    return &d_ptr->framePool;
+}
+
+
+// Decodes until the end of the clip or until aborted. A change of the
+// playback direction also makes decode() return; the decoder then
+// repositions itself next to the frame delivered last and carries on in
+// the new direction, without the GUI thread waiting for it.
+void DecoderThread::run(void)
+{
+    Q_D(DecoderThread);
+    static const AVRational msTimeBase = {1, 1000};
+    d->doAbort = false;
+    forever {
+        decode();
+        QMutexLocker locker(&d->pauseMutex);
+        if (!d->flipPending)
+            break;
+        d->flipPending = false;
+        d->doAbort = false;
+        d->seekPending = false;
+        const bool reverse = d->reverse;
+        d->direction = reverse ? -1 : +1;
+        // reverse playback ends right before the last frame, forward playback starts right after it
+        d->seekTargetMs = reverse ? -1 : d->lastPts + qMax(Q_INT64_C(1), d->frameDurationMs);
+        locker.unlock();
+        // the recorded frame timestamps won't be complete any more
+        d->recordFramePts = false;
+        d->demuxer->setFramePtsRecorder(nullptr);
+        if (!reverse && !d->clipStore.isComplete()) {
+            const int64_t target = av_rescale_q(d->seekTargetMs, msTimeBase, d->videoStream->time_base);
+            const KeyframeIndex::Entry &keyframe = d->keyframeIndex.preceding(target);
+            av_seek_frame(d->fmtCtx, d->videoStreamIdx, keyframe.isValid() ? keyframe.pts : target, AVSEEK_FLAG_BACKWARD);
+            avcodec_flush_buffers(d->videoDecCtx);
+        }
+    }
+}
+
+
+void DecoderThread::decode(void)
+{
+    Q_D(DecoderThread);
+    d->frameQueue.resume();
+    d->ahead.clear();
+    d->pauseMutex.lock();
+    const VideoFrame cached = d->cachedFrame;
+    d->cachedFrame = VideoFrame();
+    const bool deliverCachedOnly = d->restartPending;
+    const bool reverse = d->reverse;
+    d->pauseMutex.unlock();
+    if (!cached.isNull()) {
+        if (!d->frameQueue.push(cached))
+            return;
+        emit positionChanged(cached.pts);
+        emit frameAvailable();
+        emit seekCompleted(cached.pts, d->seekTimer.elapsed());
+        if (deliverCachedOnly)
+            return;
+    }
+    d->firstFrame = true;
+    d->lastDecodedPts = -1;
+    d->lastFrameTime = -1;
+    setDiscardLevel(DiscardNothing);
+    d->throughputTimer.invalidate();
+    if (d->clipStore.isComplete()) {
+        presentFromStore();
+        logThroughput();
+        return;
+    }
+    if (reverse) {
+        playReverse();
+        logThroughput();
+        return;
+    }
+    d->preloading = d->preloadClip;
+    d->preloadOverBudget = false;
+    if (d->preloading) {
+        // the whole clip goes into the store, regardless of where playback is to start
+        d->clipStore.clear();
+        av_seek_frame(d->fmtCtx, d->videoStreamIdx, 0, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(d->videoDecCtx);
+        d->preloadTimer.start();
+    }
+    d->packetQueue.reset();
+    d->demuxer->start();
+    d->busyNs = 0;
+    d->fpsFrameCount = 0;
+    d->fpsTimer.start();
+    av_init_packet(&d->pkt);
+    d->pkt.data = nullptr;
+    d->pkt.size = 0;
+    d->rc = 0;
+    int gotFrame = 0;
+    while (!d->doAbort && !d->preloadOverBudget) {
+        if (!d->packetQueue.pop(&d->pkt))
+            break;
+        AVPacket origPkt = d->pkt;
+        do {
+            int ret = decodePacket(gotFrame);
+            if (ret < 0)
+                break;
+            d->pkt.data += ret;
+            d->pkt.size -= ret;
+        } while (d->pkt.size > 0);
+        av_free_packet(&origPkt);
+    }
+    if (d->preloadOverBudget) {
+        // the clip is played from disk after all, from where it was asked for
+        qDebug() << "DecoderThread: preloaded clip exceeds" << d->preloadMaxBytes / 1024 / 1024 << "MB, playing it from disk.";
+        d->packetQueue.cancel();
+        d->demuxer->wait();
+        d->preloading = false;
+        d->preloadClip = false;
+        d->preloadOverBudget = false;
+        d->clipStore.clear();
+        if (d->recordFramePts) {
+            d->framePts.clear();
+            d->recordFramePts = d->seekTargetMs <= 0;
+            d->demuxer->setFramePtsRecorder(d->recordFramePts ? &d->framePts : nullptr);
+        }
+        static const AVRational msTimeBase = {1, 1000};
+        const int64_t target = av_rescale_q(qMax(Q_INT64_C(0), d->seekTargetMs), msTimeBase, d->videoStream->time_base);
+        const KeyframeIndex::Entry &keyframe = d->keyframeIndex.preceding(target);
+        av_seek_frame(d->fmtCtx, d->videoStreamIdx, keyframe.isValid() ? keyframe.pts : target, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(d->videoDecCtx);
+        decode();
+        return;
+    }
+    qDebug().nospace() << "DecoderThread " << (d->doAbort ? "canceled" : "finished decoding uncached frames") << ".";
+    if (!d->doAbort) {
+        d->pkt.data = nullptr;
+        d->pkt.size = 0;
+        do  {
+            decodePacket(gotFrame);
+        } while (gotFrame && !d->doAbort);
+        deliverFrames(true);
+    }
+    d->packetQueue.cancel();
+    d->demuxer->wait();
+    if (d->preloading) {
+        d->preloading = false;
+        if (d->doAbort) {
+            d->clipStore.clear();
+        }
+        else {
+            d->clipStore.setComplete();
+            qDebug() << "DecoderThread: preloaded" << d->clipStore.count() << "frames in" << d->preloadTimer.elapsed() << "ms,"
+                     << d->clipStore.bytes() / 1024 << "KB of" << d->clipStore.uncompressedBytes() / 1024 << "KB uncompressed";
+            emit preloadFinished(d->clipStore.count(), d->clipStore.bytes(), d->preloadTimer.elapsed());
+        }
+    }
+    if (!d->doAbort && d->recordFramePts && !d->framePts.isEmpty()) {
+        if (d->streamInfo.durationMs <= 0)
+            d->streamInfo.durationMs = d->lastPts + d->frameDurationMs;
+        // the sidecar can't be replaced while it's mapped, at least not on Windows
+        QMutexLocker locker(&d->indexMutex);
+        d->mediaIndex.unload();
+        if (MediaIndex::save(d->filename, d->streamInfo, d->framePts, d->keyframeIndex.entries()))
+            qDebug() << "Wrote media index with" << d->framePts.count() << "frames to" << MediaIndex::sidecarFilename(d->filename);
+        else
+            qWarning() << "DecoderThread: cannot write" << MediaIndex::sidecarFilename(d->filename);
+        d->mediaIndex.load(d->filename);
+        d->recordFramePts = false;
+        d->demuxer->setFramePtsRecorder(nullptr);
+    }
+    qDebug() << "DecoderThread ending ... frame pool high-water mark:" << d->framePool.highWaterMark()
+             << "allocation misses:" << d->framePool.allocationMisses()
+             << "frame queue high-water mark:" << d->frameQueue.highWaterMark()
+             << "stalls:" << d->frameQueue.stalls()
+             << "drops:" << d->frameQueue.drops()
+             << "frame cache hits:" << d->frameCache.hits()
+             << "misses:" << d->frameCache.misses()
+             << "size:" << d->frameCache.bytes() / 1024 << "KB"
+             << "dropped frames:" << d->droppedFrameCount.load();
+    if (!d->doAbort && d->clipStore.isComplete())
+        presentFromStore();
+    logConversion();
+    logThroughput();
+}
+
+
+int DecoderThread::decodePacket(int &gotFrame)
+{
+    Q_D(DecoderThread);
+    int ret = 0;
+    int decoded = d->pkt.size;
+    gotFrame = 0;
+    QElapsedTimer busyTimer;
+    busyTimer.start();
+    ret = avcodec_decode_video2(d->videoDecCtx, d->frame, &gotFrame, &d->pkt);
+    if (ret < 0)
+        return ret;
+    if (!gotFrame)
+        d->busyNs += busyTimer.nsecsElapsed();
+    if (gotFrame) {
+        // with frame threading the decoded frame doesn't belong to the packet just fed in
+        const qint64 t = d->frameTime();
+        if (d->preloading) {
+            const VideoFrame videoFrame = convertFrame(t);
+            if (videoFrame.isNull())
+                return -1;
+            av_frame_unref(d->frame);
+            d->clipStore.append(videoFrame);
+            d->busyNs += busyTimer.nsecsElapsed();
+            if (d->clipStore.bytes() > d->preloadMaxBytes)
+                d->preloadOverBudget = true;
+            return decoded;
+        }
+        if (d->seekTargetMs >= 0) {
+            if (t + d->frameDurationMs <= d->seekTargetMs) {
+                // when stepping backward the frames right before the target are the next ones asked for
+                const bool prefetch = d->direction < 0
+                        && d->seekTargetMs - t <= d->prefetchFrames * qMax(Q_INT64_C(1), d->frameDurationMs)
+                        && !d->frameCache.contains(t);
+                if (prefetch) {
+                    const VideoFrame videoFrame = convertFrame(t);
+                    if (videoFrame.isNull())
+                        return -1;
+                    d->frameCache.insert(videoFrame);
+                }
+                av_frame_unref(d->frame);
+                d->busyNs += busyTimer.nsecsElapsed();
+                return decoded;
+            }
+            d->seekTargetMs = -1;
+        }
+        d->pauseMutex.lock();
+        const bool adapt = d->adaptiveDropping && !d->paused;
+        d->discardFloor = d->paused ? int(DiscardNothing) : d->speedDiscardLevel;
+        d->pauseMutex.unlock();
+        if ((!adapt && d->discardLevel != d->discardFloor) || d->discardLevel < d->discardFloor)
+            setDiscardLevel(d->discardFloor);
+        const qint64 frameDurationMs = qMax(Q_INT64_C(1), d->frameDurationMs);
+        // frames skipped because of the playback speed don't count as dropped
+        if (d->discardLevel >= SkipNonRefFrames && d->discardLevel > d->discardFloor && d->lastDecodedPts >= 0) {
+            // the codec doesn't output the frames it skipped, so derive them from the gap
+            for (qint64 missing = d->lastDecodedPts + frameDurationMs; missing + frameDurationMs / 2 < t; missing += frameDurationMs)
+                logDroppedFrame(missing);
+        }
+        d->lastDecodedPts = t;
+        if (adapt && d->clock->isValid()) {
+            const qint64 lagMs = d->clock->time() - t;
+            adaptDiscardLevel(lagMs);
+            if (lagMs > DecoderThreadPrivate::LateFrames * frameDurationMs) {
+                // too late to be shown anyway, so don't spend time on converting it
+                logDroppedFrame(t);
+                av_frame_unref(d->frame);
+                d->busyNs += busyTimer.nsecsElapsed();
+                return decoded;
+            }
+        }
+        const VideoFrame videoFrame = convertFrame(t);
+        if (videoFrame.isNull())
+            return -1;
+        av_frame_unref(d->frame);
+        d->busyNs += busyTimer.nsecsElapsed();
+        ++d->fpsFrameCount;
+        if (d->fpsTimer.elapsed() > 1000 && d->busyNs > 0) {
+            d->decodeFps = 1e9 * d->fpsFrameCount / d->busyNs;
+            emit decodeFpsChanged(d->decodeFps);
+            d->busyNs = 0;
+            d->fpsFrameCount = 0;
+            d->fpsTimer.restart();
+        }
+        d->frameCache.insert(videoFrame);
+        d->pauseMutex.lock();
+        d->ahead.enqueue(videoFrame);
+        d->pauseMutex.unlock();
+        if (!deliverFrames(false))
+            return -1;
+    }
+    return decoded;
+}
+
+
+// Turns the decoded frame into a YUV420P frame of output size. If the
+// decoder already produced exactly that, the frame refers to the decoder's
+// own buffers, as long as not more than MaxPinnedFrames do. Otherwise it is
+// converted into a pooled frame, with any scaling left after decoding at
+// reduced resolution done in the same pass.
+VideoFrame DecoderThread::convertFrame(qint64 t)
+{
+    Q_D(DecoderThread);
+    const QSize size = outputSize();
+    const int srcW = d->frame->width;
+    const int srcH = d->frame->height;
+    const AVPixelFormat srcFmt = AVPixelFormat(d->frame->format);
+    const bool scaled = size != QSize(srcW, srcH);
+    const bool jpegFormat = srcFmt == AV_PIX_FMT_YUVJ420P;
+    const bool fullRange = jpegFormat || d->frame->color_range == AVCOL_RANGE_JPEG;
+    const VideoFrame::ColorMatrix colorMatrix = d->frame->colorspace == AVCOL_SPC_BT709 ? VideoFrame::BT709 : VideoFrame::BT601;
+    if (size != d->convertSize) {
+        logConversion();
+        d->convertSize = size;
+    }
+    ++d->convertFrames;
+    d->convertBytes += VideoFrame::bufferSize(size);
+    // Colour conversion is done in the shader, so the planes can be handed
+    // over as they are. Each such frame keeps one of the decoder's buffers
+    // in use, though, so only a few go out that way and the rest is copied
+    // into the pool. The frame queue alone could otherwise pin dozens.
+    if (!scaled && (srcFmt == AV_PIX_FMT_YUV420P || srcFmt == AV_PIX_FMT_YUVJ420P)
+            && d->pinnedFrames->load() < DecoderThreadPrivate::MaxPinnedFrames) {
+        AVFrame *ref = av_frame_clone(d->frame);
+        if (ref == nullptr) {
+            qWarning() << "DecoderThread: cannot reference decoded frame.";
+            return VideoFrame();
+        }
+        d->pinnedFrames->ref();
+        VideoFrame videoFrame(size, VideoFrame::Format_YUV420P, ref->data, ref->linesize,
+                              FrameBufferPtr(new FrameBuffer(ref->data[0], 0), AVFrameReleaser(ref, d->pinnedFrames)));
+        videoFrame.pts = t;
+        videoFrame.number = d->videoFrameCount++;
+        videoFrame.colorRange = fullRange ? VideoFrame::FullRange : VideoFrame::LimitedRange;
+        videoFrame.colorMatrix = colorMatrix;
+        return videoFrame;
+    }
+    VideoFrame videoFrame(size, VideoFrame::Format_YUV420P, &d->framePool);
+    videoFrame.pts = t;
+    videoFrame.number = d->videoFrameCount++;
+    // swscale squeezes the J formats into limited range, but knows nothing of the range tag
+    videoFrame.colorRange = (fullRange && !jpegFormat) ? VideoFrame::FullRange : VideoFrame::LimitedRange;
+    videoFrame.colorMatrix = colorMatrix;
+    uint8_t *dstData[4] = { videoFrame.bits(0), videoFrame.bits(1), videoFrame.bits(2), nullptr };
+    int dstLinesize[4] = { videoFrame.bytesPerLine(0), videoFrame.bytesPerLine(1), videoFrame.bytesPerLine(2), 0 };
+    d->imgConvertCtx = sws_getCachedContext(d->imgConvertCtx, srcW, srcH, srcFmt, size.width(), size.height(), AV_PIX_FMT_YUV420P,
+                                            scaled ? SWS_FAST_BILINEAR : SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (d->imgConvertCtx == nullptr) {
+        qFatal("Cannot initialize the conversion context!");
+        return VideoFrame();
+    }
+    QElapsedTimer convertTimer;
+    convertTimer.start();
+    sws_scale(d->imgConvertCtx, d->frame->data, d->frame->linesize, 0, srcH, dstData, dstLinesize);
+    d->convertNs += convertTimer.nsecsElapsed();
+    return videoFrame;
+}
+
+
+// Hands the frames decoded ahead over to the frame queue as far as pausing
+// permits. While paused up to `prefetchFrames` frames are decoded ahead
+// before the decoder goes to sleep, so stepping forward needs no decode
+// work. With `drain` set all frames are delivered before returning.
+bool DecoderThread::deliverFrames(bool drain)
+{
+    Q_D(DecoderThread);
+    QMutexLocker locker(&d->pauseMutex);
+    forever {
+        if (d->doAbort)
+            return false;
+        if (d->ahead.isEmpty())
+            return true;
+        if (d->paused && d->framesToStep == 0 && !d->firstFrame) {
+            if (!drain && d->direction > 0 && d->ahead.count() <= d->prefetchFrames)
+                return true;
+            d->pauseCond.wait(&d->pauseMutex);
+            continue;
+        }
+        if (d->firstFrame)
+            d->firstFrame = false;
+        else if (d->framesToStep > 0)
+            --d->framesToStep;
+        const VideoFrame videoFrame = d->ahead.dequeue();
+        d->lastPts = videoFrame.pts;
+        if (d->seekPending) {
+            d->seekPending = false;
+            emit seekCompleted(videoFrame.pts, d->seekTimer.elapsed());
+        }
+        const bool playing = !d->paused;
+        locker.unlock();
+        if (!d->frameQueue.push(videoFrame))
+            return false;
+        if (playing)
+            updateThroughput(videoFrame.pts);
+        else
+            d->throughputTimer.invalidate();
+        emit positionChanged(videoFrame.pts);
+        emit frameAvailable();
+        locker.relock();
+    }
+}
+
+
+// Called for every frame decoded during playback with how late it is
+// compared to the presentation clock.
+void DecoderThread::adaptDiscardLevel(qint64 lagMs)
+{
+    Q_D(DecoderThread);
+    const qint64 frameDurationMs = qMax(Q_INT64_C(1), d->frameDurationMs);
+    int level = d->discardLevel;
+    ++d->framesAtLevel;
+    if (lagMs > DecoderThreadPrivate::EscalateLateFrames * frameDurationMs) {
+        d->calmFrames = 0;
+        if (d->framesAtLevel >= DecoderThreadPrivate::SettleFrames && level < SkipNonKeyFrames)
+            ++level;
+    }
+    else if (2 * lagMs < frameDurationMs) {
+        if (++d->calmFrames >= DecoderThreadPrivate::CalmFrames && level > d->discardFloor)
+            --level;
+    }
+    else {
+        d->calmFrames = 0;
+    }
+    if (level != d->discardLevel)
+        setDiscardLevel(level);
+}
+
+
+void DecoderThread::setDiscardLevel(int level)
+{
+    Q_D(DecoderThread);
+    static const AVDiscard skipLoopFilter[] = { AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_NONREF, AVDISCARD_NONKEY };
+    static const AVDiscard skipFrame[] = { AVDISCARD_DEFAULT, AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_NONKEY };
+    if (d->videoDecCtx != nullptr) {
+        d->videoDecCtx->skip_loop_filter = skipLoopFilter[level];
+        d->videoDecCtx->skip_frame = skipFrame[level];
+    }
+    if (level != d->discardLevel)
+        qDebug() << "DecoderThread: discard level" << d->discardLevel << "->" << level;
+    d->discardLevel = level;
+    d->framesAtLevel = 0;
+    d->calmFrames = 0;
+}
+
+
+// Plays the preloaded clip from `seekTargetMs` on, or from the start, in
+// the playback direction.
+void DecoderThread::presentFromStore(void)
+{
+    Q_D(DecoderThread);
+    const int count = d->clipStore.count();
+    d->pauseMutex.lock();
+    const int step = d->reverse ? -1 : +1;
+    d->pauseMutex.unlock();
+    int i = d->clipStore.indexOf(qMax(Q_INT64_C(0), d->seekTargetMs));
+    d->seekTargetMs = -1;
+    while (!d->doAbort && i >= 0 && i < count) {
+        const VideoFrame videoFrame = d->clipStore.frame(i, &d->framePool);
+        i += step;
+        d->pauseMutex.lock();
+        d->ahead.enqueue(videoFrame);
+        d->pauseMutex.unlock();
+        if (!deliverFrames(false))
+            return;
+    }
+    deliverFrames(true);
+    qDebug() << "DecoderThread: played" << count << "frames from memory, worst-case store lookup"
+             << d->clipStore.maxLookupUs() << "us";
+}
+
+
+// Plays backwards from `seekTargetMs`, or from the frame before the one
+// delivered last. The frames between the preceding keyframe and the frame
+// shown last are decoded forward into a buffer, which is then delivered
+// back to front. Long GOPs are gone through in several passes so that the
+// buffer never holds more than ReverseBufferFrames frames. Every pass
+// decodes from the keyframe again, so a GOP of n > ReverseBufferFrames
+// frames costs about n * n / (2 * ReverseBufferFrames) decoded frames
+// instead of n. That is the price for not holding a whole long GOP in
+// memory; decoded segments don't go into the frame cache either.
+void DecoderThread::playReverse(void)
+{
+    Q_D(DecoderThread);
+    qint64 endMs = d->seekTargetMs >= 0 ? d->seekTargetMs + 1 : d->lastPts;
+    d->seekTargetMs = -1;
+    d->pauseMutex.lock();
+    d->direction = -1;
+    d->discardFloor = d->speedDiscardLevel;
+    d->pauseMutex.unlock();
+    setDiscardLevel(d->discardFloor);
+    QVector<VideoFrame> segment;
+    segment.reserve(ReverseBufferFrames + 1);
+    while (!d->doAbort && endMs > 0) {
+        if (!decodeSegment(endMs, segment) || segment.isEmpty())
+            break;
+        for (int i = segment.count() - 1; i >= 0; --i) {
+            d->pauseMutex.lock();
+            d->ahead.enqueue(segment.at(i));
+            d->pauseMutex.unlock();
+            if (!deliverFrames(false))
+                return;
+        }
+        endMs = segment.first().pts;
+        segment.clear();
+    }
+    deliverFrames(true);
+}
+
+
+// Decodes the frames from the keyframe preceding `endMs` up to, but not
+// including, `endMs` into `segment`, keeping the last ReverseBufferFrames
+// of them. Packets are read directly, the demuxer thread isn't running
+// during reverse playback.
+bool DecoderThread::decodeSegment(qint64 endMs, QVector<VideoFrame> &segment)
+{
+    Q_D(DecoderThread);
+    static const AVRational ms = {1, 1000};
+    const int64_t target = av_rescale_q(qMax(Q_INT64_C(0), endMs - 1), ms, d->videoStream->time_base);
+    const KeyframeIndex::Entry &keyframe = d->keyframeIndex.preceding(target);
+    if (av_seek_frame(d->fmtCtx, d->videoStreamIdx, keyframe.isValid() ? keyframe.pts : target, AVSEEK_FLAG_BACKWARD) < 0)
+        return false;
+    avcodec_flush_buffers(d->videoDecCtx);
+    d->lastFrameTime = -1;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    bool eof = false;
+    bool done = false;
+    while (!done && !d->doAbort) {
+        if (!eof) {
+            if (av_read_frame(d->fmtCtx, &pkt) < 0) {
+                eof = true;
+                pkt.data = nullptr;
+                pkt.size = 0;
+            }
+            else if (pkt.stream_index != d->videoStreamIdx) {
+                av_free_packet(&pkt);
+                continue;
+            }
+        }
+        int gotFrame = 0;
+        const int ret = avcodec_decode_video2(d->videoDecCtx, d->frame, &gotFrame, &pkt);
+        if (!eof)
+            av_free_packet(&pkt);
+        if (ret < 0 || !gotFrame) {
+            done = eof;
+            continue;
+        }
+        const qint64 t = d->frameTime();
+        if (t >= endMs) {
+            done = true;
+        }
+        else {
+            const VideoFrame videoFrame = convertFrame(t);
+            if (videoFrame.isNull()) {
+                av_frame_unref(d->frame);
+                return false;
+            }
+            segment.append(videoFrame);
+            if (segment.count() > ReverseBufferFrames)
+                segment.remove(0);
+        }
+        av_frame_unref(d->frame);
+    }
+    return !d->doAbort;
+}
+
+
+// Called for every frame delivered during playback. Reports the frame rate
+// and the rate at which media time advances once per second.
+void DecoderThread::updateThroughput(qint64 pts)
+{
+    Q_D(DecoderThread);
+    const qreal speed = d->clock->speed();
+    if (!d->throughputTimer.isValid() || speed != d->throughputSpeed) {
+        d->throughputTimer.start();
+        d->throughputSpeed = speed;
+        d->throughputFrames = 0;
+        d->throughputStartPts = pts;
+        return;
+    }
+    ++d->throughputFrames;
+    const qint64 elapsedMs = d->throughputTimer.elapsed();
+    if (elapsedMs < 1000)
+        return;
+    const qint64 mediaMs = qAbs(pts - d->throughputStartPts);
+    emit throughputChanged(speed, 1e3 * d->throughputFrames / elapsedMs, qreal(mediaMs) / elapsedMs);
+    DecoderThreadPrivate::Throughput &total = d->throughput[speed];
+    total.frames += d->throughputFrames;
+    total.wallMs += elapsedMs;
+    total.mediaMs += mediaMs;
+    d->throughputTimer.start();
+    d->throughputFrames = 0;
+    d->throughputStartPts = pts;
+}
+
+
+void DecoderThread::logThroughput(void)
+{
+    Q_D(DecoderThread);
+    QMap<qreal, DecoderThreadPrivate::Throughput>::const_iterator it;
+    for (it = d->throughput.constBegin(); it != d->throughput.constEnd(); ++it) {
+        if (it.value().wallMs <= 0)
+            continue;
+        qDebug() << "DecoderThread: at" << it.key() << "x sustained"
+                 << 1e3 * it.value().frames / it.value().wallMs << "fps,"
+                 << qreal(it.value().mediaMs) / it.value().wallMs << "x real time";
+    }
+}
+
+
+// Reports what the frames of the output size cost to convert and how much
+// they weigh when uploaded, so the savings of a smaller output size can be read off the log.
+void DecoderThread::logConversion(void)
+{
+    Q_D(DecoderThread);
+    if (d->convertFrames > 0) {
+        qDebug() << "DecoderThread:" << d->convertFrames << "frames at" << d->convertSize
+                 << "of" << QSize(d->w, d->h) << "took"
+                 << 1e-3 * d->convertNs / d->convertFrames << "us to convert and"
+                 << d->convertBytes / d->convertFrames / 1024 << "KB to upload per frame";
+    }
+    d->convertFrames = 0;
+    d->convertNs = 0;
+    d->convertBytes = 0;
+}
+
+
+void DecoderThread::logDroppedFrame(qint64 pts)
+{
+    Q_D(DecoderThread);
+    // not logged one by one, frames are dropped exactly when there's no time to spare; the total is logged when the thread ends
+    d->droppedFrameCount.ref();
+    emit frameDropped(pts);
+}
@@ -1,47 +1,137 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#ifndef __DECODERTHREAD_H_
-#define __DECODERTHREAD_H_
-
-#include <QThread>
-#include <QImage>
-#include <QScopedPointer>
-
-#include "semaphores.h"
-
-
-
-class DecoderThreadPrivate;
-
-class DecoderThread : public QThread
-{
-    Q_OBJECT
-public:
-    explicit DecoderThread(QObject *parent = nullptr);
-
-    bool openVideo(const QString &filename);
-    void abort(void);
-
-protected:
-    virtual void run(void);
-
-signals:
-    void frameReady(QImage, int);
-    void positionChanged(qint64);
-    void durationChanged(qint64);
-
-public slots:
-
-private: // methods
-    int decodePacket(int &gotFrame);
-
-private:
-    QScopedPointer<DecoderThreadPrivate> d_ptr;
-    Q_DECLARE_PRIVATE(DecoderThread)
-    Q_DISABLE_COPY(DecoderThread)
-
-
-};
-
-#endif // __DECODERTHREAD_H_
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __DECODERTHREAD_H_
+#define __DECODERTHREAD_H_
+
+#include <QThread>
+#include <QImage>
+#include <QScopedPointer>
+
+#include "videoframe.h"
+#include "framepool.h"
+#include "framequeue.h"
+#include "framecache.h"
+#include "presentationclock.h"
+#include "packetqueue.h"
+#include "keyframeindex.h"
+#include "mediaindex.h"
+#include "mediainput.h"
+#include "clipstore.h"
+
+
+
+class DecoderThreadPrivate;
+
+class DecoderThread : public QThread
+{
+    Q_OBJECT
+public:
+    enum ThreadType {
+        FrameThreading,
+        SliceThreading
+    };
+    static const int DefaultPrefetchFrames = 8;
+    // frames queued for presentation; the pool holds two more, each as big as an output frame
+    static const int DefaultQueueDepth = DefaultPrefetchFrames;
+    static const int DefaultPreloadMaxMs = 30 * 1000;
+    static const int DefaultPreloadMaxMB = 512;
+    // frames of a GOP buffered for reverse playback
+    static const int ReverseBufferFrames = 48;
+    enum DiscardLevel {
+        DiscardNothing,
+        SkipNonRefLoopFilter,
+        SkipNonRefFrames,
+        SkipNonKeyFrames
+    };
+
+    explicit DecoderThread(QObject *parent = nullptr);
+
+    bool openVideo(const QString &filename);
+    void abort(void);
+    void setQueueDepth(int);
+    void setPacketQueueLimits(int maxBytes, int maxDurationMs, qreal lowWatermark = 0.5);
+    const PacketQueue *packetQueue(void) const;
+    void setDecoderThreads(int count, ThreadType type = FrameThreading);
+    int decoderThreadCount(void) const;
+    ThreadType decoderThreadType(void) const;
+    qreal decodeFps(void) const;
+    const KeyframeIndex *keyframeIndex(void) const;
+    void setFrameCacheBudget(qint64 bytes);
+    const FrameCache *frameCache(void) const;
+    void setPrefetchFrames(int n);
+    int prefetchFrames(void) const;
+    void setAdaptiveDropping(bool enabled);
+    bool adaptiveDropping(void) const;
+    int droppedFrameCount(void) const;
+    PresentationClock *presentationClock(void);
+    void setPresentationClock(PresentationClock *clock);
+    qreal speed(void) const;
+    void setConsumerResolution(const QString &consumer, const QSize &size);
+    void removeConsumer(const QString &consumer);
+    QSize outputSize(void) const;
+    QSize videoSize(void) const;
+    void setInputMode(MediaInput::Mode mode, int readAheadWindow = MediaInput::DefaultReadAheadWindow);
+    MediaInput::Mode inputMode(void) const;
+    const MediaInput *mediaInput(void) const;
+    void setPreload(bool enabled, qint64 maxDurationMs = DefaultPreloadMaxMs, bool compressed = false,
+                    qint64 maxBytes = Q_INT64_C(1024) * 1024 * DefaultPreloadMaxMB);
+    bool preloadEnabled(void) const;
+    qint64 preloadMaxDuration(void) const;
+    qint64 preloadMaxBytes(void) const;
+    bool preloadCompressed(void) const;
+    const ClipStore *clipStore(void) const;
+    qint64 duration(void) const;
+    qint64 frameDuration(void) const;
+    int gopLength(void) const;
+    bool isPaused(void) const;
+    qint64 position(void) const;
+    FrameQueue *frameQueue(void);
+    const FramePool *framePool(void) const;
+
+protected:
+    virtual void run(void);
+
+signals:
+    void frameAvailable(void);
+    void positionChanged(qint64);
+    void durationChanged(qint64);
+    void decodeFpsChanged(qreal);
+    void seekCompleted(qint64 position, qint64 latencyMs);
+    void frameDropped(qint64 pts);
+    void preloadFinished(int frames, qint64 bytes, qint64 elapsedMs);
+    void throughputChanged(qreal speed, qreal fps, qreal mediaRate);
+
+public slots:
+    void seek(qint64 ms, bool invalidateClock = true);
+    void stepFrame(int n);
+    void setPaused(bool);
+    void setSpeed(qreal);
+
+private: // methods
+    void closeVideo(void);
+    bool openCodec(void);
+    void outputSizeChanged(void);
+    void decode(void);
+    int decodePacket(int &gotFrame);
+    VideoFrame convertFrame(qint64 t);
+    bool deliverFrames(bool drain);
+    void adaptDiscardLevel(qint64 lagMs);
+    void setDiscardLevel(int level);
+    void logDroppedFrame(qint64 pts);
+    void presentFromStore(void);
+    void playReverse(void);
+    bool decodeSegment(qint64 endMs, QVector<VideoFrame> &segment);
+    void updateThroughput(qint64 pts);
+    void logThroughput(void);
+    void logConversion(void);
+
+private:
+    QScopedPointer<DecoderThreadPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(DecoderThread)
+    Q_DISABLE_COPY(DecoderThread)
+
+
+};
+
+#endif // __DECODERTHREAD_H_
@@ -0,0 +1,114 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+
+#include "demuxerthread.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+
+class DemuxerThreadPrivate {
+public:
+    explicit DemuxerThreadPrivate(PacketQueue *queue)
+        : doAbort(false)
+        , queue(queue)
+        , fmtCtx(nullptr)
+        , streamIdx(-1)
+        , keyframeIndex(nullptr)
+        , framePts(nullptr)
+    { /* ... */ }
+    volatile bool doAbort;
+    PacketQueue *queue;
+    AVFormatContext *fmtCtx;
+    int streamIdx;
+    KeyframeIndex *keyframeIndex;
+    QVector<qint64> *framePts;
+};
+
+
+DemuxerThread::DemuxerThread(PacketQueue *queue, QObject *parent)
+    : QThread(parent)
+    , d_ptr(new DemuxerThreadPrivate(queue))
+{
+    // ...
+}
+
+
+DemuxerThread::~DemuxerThread()
+{
+    abort();
+}
+
+
+// Must not be called while the thread is running.
+void DemuxerThread::setSource(AVFormatContext *fmtCtx, int streamIdx)
+{
+    Q_D(DemuxerThread);
+    Q_ASSERT(!isRunning());
+    d->fmtCtx = fmtCtx;
+    d->streamIdx = streamIdx;
+}
+
+
+// Keyframes passing through the demuxer are added to `index`.
+void DemuxerThread::setKeyframeIndex(KeyframeIndex *index)
+{
+    Q_D(DemuxerThread);
+    d->keyframeIndex = index;
+}
+
+
+// The timestamps of all packets read are appended to `framePts`.
+// Must not be called while the thread is running.
+void DemuxerThread::setFramePtsRecorder(QVector<qint64> *framePts)
+{
+    Q_D(DemuxerThread);
+    Q_ASSERT(!isRunning());
+    d->framePts = framePts;
+}
+
+
+void DemuxerThread::abort(void)
+{
+    Q_D(DemuxerThread);
+    d->doAbort = true;
+    d->queue->cancel();
+    wait();
+}
+
+
+void DemuxerThread::run(void)
+{
+    Q_D(DemuxerThread);
+    d->doAbort = false;
+    if (d->fmtCtx == nullptr)
+        return;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = nullptr;
+    pkt.size = 0;
+    while (!d->doAbort) {
+        const int rc = av_read_frame(d->fmtCtx, &pkt);
+        if (rc < 0)
+            break;
+        if (pkt.stream_index != d->streamIdx) {
+            av_free_packet(&pkt);
+            continue;
+        }
+        const int64_t ts = (pkt.pts != AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+        if (ts != AV_NOPTS_VALUE) {
+            if (d->keyframeIndex != nullptr && (pkt.flags & AV_PKT_FLAG_KEY))
+                d->keyframeIndex->add(ts, pkt.pos);
+            if (d->framePts != nullptr)
+                d->framePts->append(ts);
+        }
+        if (!d->queue->push(&pkt))
+            break;
+    }
+    d->queue->setEof();
+    qDebug() << "DemuxerThread ending ... packet queue underruns:" << d->queue->underruns()
+             << "high-water hits:" << d->queue->highWaterHits();
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __DEMUXERTHREAD_H_
+#define __DEMUXERTHREAD_H_
+
+#include <QThread>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "packetqueue.h"
+#include "keyframeindex.h"
+
+struct AVFormatContext;
+
+class DemuxerThreadPrivate;
+
+// Reads packets of one stream from a container ahead of the decoder.
+class DemuxerThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit DemuxerThread(PacketQueue *queue, QObject *parent = nullptr);
+    virtual ~DemuxerThread();
+
+    void setSource(AVFormatContext *fmtCtx, int streamIdx);
+    void setKeyframeIndex(KeyframeIndex *);
+    void setFramePtsRecorder(QVector<qint64> *);
+    void abort(void);
+
+protected:
+    virtual void run(void);
+
+private:
+    QScopedPointer<DemuxerThreadPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(DemuxerThread)
+    Q_DISABLE_COPY(DemuxerThread)
+
+};
+
+#endif // __DEMUXERTHREAD_H_
@@ -0,0 +1,175 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+#include "framebroadcaster.h"
+
+
+class Subscriber {
+public:
+    Subscriber(FrameBroadcaster::Policy policy, int capacity)
+        : policy(policy)
+        , capacity(qMax(1, capacity))
+        , drops(0)
+    { /* ... */ }
+    FrameBroadcaster::Policy policy;
+    int capacity;
+    QQueue<VideoFrame> queue;
+    QWaitCondition notFull;
+    int drops;
+};
+
+typedef QSharedPointer<Subscriber> SubscriberPtr;
+
+
+class FrameBroadcasterPrivate {
+public:
+    FrameBroadcasterPrivate(void)
+    { /* ... */ }
+    // Returns false if the frame had to be dropped.
+    bool enqueue(Subscriber *sub, const VideoFrame &frame)
+    {
+        if (sub->queue.count() >= sub->capacity) {
+            switch (sub->policy) {
+            case FrameBroadcaster::Block:
+                if (!sub->notFull.wait(&mtx, FrameBroadcaster::BlockTimeoutMs) || sub->queue.count() >= sub->capacity) {
+                    ++sub->drops;
+                    return false;
+                }
+                break;
+            case FrameBroadcaster::DropOldest:
+                sub->queue.dequeue();
+                ++sub->drops;
+                break;
+            case FrameBroadcaster::LatestOnly:
+                sub->drops += sub->queue.count();
+                sub->queue.clear();
+                break;
+            }
+        }
+        sub->queue.enqueue(frame);
+        return true;
+    }
+    // Queues the frame for each of `subs`. Returns the names of the
+    // subscribers that got the frame.
+    QStringList deliver(const QList<QPair<QString, SubscriberPtr> > &subs, const VideoFrame &frame)
+    {
+        QStringList names;
+        for (int i = 0; i < subs.count(); ++i) {
+            if (enqueue(subs.at(i).second.data(), frame))
+                names.append(subs.at(i).first);
+        }
+        return names;
+    }
+
+    mutable QMutex mtx;
+    QMap<QString, SubscriberPtr> subscribers;
+};
+
+
+FrameBroadcaster::FrameBroadcaster(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new FrameBroadcasterPrivate)
+{
+    // ...
+}
+
+
+FrameBroadcaster::~FrameBroadcaster()
+{
+    foreach (const QString &name, subscribers())
+        qDebug() << "FrameBroadcaster: subscriber" << name << "dropped" << drops(name) << "frames.";
+}
+
+
+// Subscribing again under the same name replaces the previous subscription.
+void FrameBroadcaster::subscribe(const QString &name, Policy policy, int capacity)
+{
+    Q_D(FrameBroadcaster);
+    QMutexLocker locker(&d->mtx);
+    d->subscribers.insert(name, SubscriberPtr(new Subscriber(policy, capacity)));
+}
+
+
+void FrameBroadcaster::unsubscribe(const QString &name)
+{
+    Q_D(FrameBroadcaster);
+    QMutexLocker locker(&d->mtx);
+    SubscriberPtr sub = d->subscribers.take(name);
+    if (!sub.isNull())
+        sub->notFull.wakeAll();
+}
+
+
+QStringList FrameBroadcaster::subscribers(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->subscribers.keys();
+}
+
+
+bool FrameBroadcaster::tryPop(const QString &name, VideoFrame &frame)
+{
+    Q_D(FrameBroadcaster);
+    QMutexLocker locker(&d->mtx);
+    SubscriberPtr sub = d->subscribers.value(name);
+    if (sub.isNull() || sub->queue.isEmpty())
+        return false;
+    frame = sub->queue.dequeue();
+    sub->notFull.wakeAll();
+    return true;
+}
+
+
+int FrameBroadcaster::count(const QString &name) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    SubscriberPtr sub = d_ptr->subscribers.value(name);
+    return sub.isNull() ? 0 : sub->queue.count();
+}
+
+
+int FrameBroadcaster::drops(const QString &name) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    SubscriberPtr sub = d_ptr->subscribers.value(name);
+    return sub.isNull() ? 0 : sub->drops;
+}
+
+
+// Hands the frame to all subscribers. Subscribers that don't block are
+// served first, so that a blocking one can't hold up the others.
+void FrameBroadcaster::publish(const VideoFrame &frame)
+{
+    Q_D(FrameBroadcaster);
+    if (frame.isNull())
+        return;
+    QMutexLocker locker(&d->mtx);
+    QList<QPair<QString, SubscriberPtr> > nonBlocking;
+    QList<QPair<QString, SubscriberPtr> > blocking;
+    for (QMap<QString, SubscriberPtr>::const_iterator it = d->subscribers.constBegin(); it != d->subscribers.constEnd(); ++it) {
+        if (it.value()->policy == Block)
+            blocking.append(qMakePair(it.key(), it.value()));
+        else
+            nonBlocking.append(qMakePair(it.key(), it.value()));
+    }
+    const QStringList &ready = d->deliver(nonBlocking, frame);
+    locker.unlock();
+    foreach (const QString &name, ready)
+        emit frameAvailable(name);
+    if (blocking.isEmpty())
+        return;
+    locker.relock();
+    const QStringList &unblocked = d->deliver(blocking, frame);
+    locker.unlock();
+    foreach (const QString &name, unblocked)
+        emit frameAvailable(name);
+}
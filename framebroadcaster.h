@@ -0,0 +1,58 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMEBROADCASTER_H_
+#define __FRAMEBROADCASTER_H_
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "videoframe.h"
+
+
+class FrameBroadcasterPrivate;
+
+// Fans frames out from one source to any number of named subscribers.
+// Each subscriber has a bounded queue of its own and a policy deciding
+// what happens when it is full. Frames are passed on as published;
+// choosing the format and resolution is up to the decoder.
+class FrameBroadcaster : public QObject
+{
+    Q_OBJECT
+public:
+    enum Policy {
+        // wait for room in the queue; meant for consumers in other threads which must not miss a frame
+        Block,
+        // make room by discarding the oldest queued frame
+        DropOldest,
+        // keep only the most recent frame
+        LatestOnly
+    };
+    static const int BlockTimeoutMs = 200;
+
+    explicit FrameBroadcaster(QObject *parent = nullptr);
+    ~FrameBroadcaster();
+
+    void subscribe(const QString &name, Policy policy, int capacity = 1);
+    void unsubscribe(const QString &name);
+    QStringList subscribers(void) const;
+    bool tryPop(const QString &name, VideoFrame &frame);
+    int count(const QString &name) const;
+    int drops(const QString &name) const;
+
+signals:
+    void frameAvailable(const QString &name);
+
+public slots:
+    void publish(const VideoFrame &);
+
+private:
+    QScopedPointer<FrameBroadcasterPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(FrameBroadcaster)
+    Q_DISABLE_COPY(FrameBroadcaster)
+
+};
+
+#endif // __FRAMEBROADCASTER_H_
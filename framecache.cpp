@@ -0,0 +1,176 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <list>
+
+#include "framecache.h"
+
+
+class FrameCachePrivate {
+public:
+    struct Entry {
+        VideoFrame frame;
+        std::list<qint64>::iterator lru;
+    };
+    explicit FrameCachePrivate(qint64 budget)
+        : budget(budget)
+        , bytes(0)
+        , hits(0)
+        , misses(0)
+    { /* ... */ }
+    void touch(QMap<qint64, Entry>::iterator it)
+    {
+        lru.splice(lru.begin(), lru, it->lru);
+    }
+    void remove(QMap<qint64, Entry>::iterator it)
+    {
+        bytes -= VideoFrame::bufferSize(it->frame.size(), it->frame.pixelFormat());
+        lru.erase(it->lru);
+        frames.erase(it);
+    }
+    void evict(void)
+    {
+        while (bytes > budget && !lru.empty())
+            remove(frames.find(lru.back()));
+    }
+    mutable QMutex mtx;
+    // ordered by pts so that a timestamp between two frames finds the one being displayed at that time
+    QMap<qint64, Entry> frames;
+    // most recently used first
+    std::list<qint64> lru;
+    qint64 budget;
+    qint64 bytes;
+    int hits;
+    int misses;
+};
+
+
+FrameCache::FrameCache(qint64 budget)
+    : d_ptr(new FrameCachePrivate(budget))
+{
+    // ...
+}
+
+
+FrameCache::~FrameCache()
+{
+    // ...
+}
+
+
+void FrameCache::setBudget(qint64 bytes)
+{
+    Q_D(FrameCache);
+    QMutexLocker locker(&d->mtx);
+    d->budget = bytes;
+    d->evict();
+}
+
+
+qint64 FrameCache::budget(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->budget;
+}
+
+
+// The cache holds a copy of the frame. Sharing the frame's buffer would
+// keep pool buffers or the decoder's own frames in use for as long as the
+// frame stays cached, and the decoder would run out of them.
+void FrameCache::insert(const VideoFrame &frame)
+{
+    Q_D(FrameCache);
+    if (frame.isNull())
+        return;
+    const qint64 size = VideoFrame::bufferSize(frame.size(), frame.pixelFormat());
+    QMutexLocker locker(&d->mtx);
+    if (size > d->budget)
+        return;
+    QMap<qint64, FrameCachePrivate::Entry>::iterator it = d->frames.find(frame.pts);
+    if (it != d->frames.end()) {
+        d->touch(it);
+        return;
+    }
+    locker.unlock();
+    const VideoFrame &copy = frame.copy();
+    locker.relock();
+    if (d->frames.contains(frame.pts))
+        return;
+    d->lru.push_front(frame.pts);
+    FrameCachePrivate::Entry entry;
+    entry.frame = copy;
+    entry.lru = d->lru.begin();
+    d->frames.insert(frame.pts, entry);
+    d->bytes += size;
+    d->evict();
+}
+
+
+// Looks for the frame that is on screen at `ms`, i.e. the last one starting
+// at or before `ms` and not ending before it.
+bool FrameCache::lookup(qint64 ms, qint64 frameDurationMs, VideoFrame &frame)
+{
+    Q_D(FrameCache);
+    QMutexLocker locker(&d->mtx);
+    QMap<qint64, FrameCachePrivate::Entry>::iterator it = d->frames.upperBound(ms);
+    if (it != d->frames.begin()) {
+        --it;
+        if (it.key() == ms || ms < it.key() + frameDurationMs) {
+            d->touch(it);
+            frame = it->frame;
+            ++d->hits;
+            return true;
+        }
+    }
+    ++d->misses;
+    return false;
+}
+
+
+// Doesn't count as a hit or miss and doesn't change the order of eviction.
+bool FrameCache::contains(qint64 pts) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->frames.contains(pts);
+}
+
+
+void FrameCache::clear(void)
+{
+    Q_D(FrameCache);
+    QMutexLocker locker(&d->mtx);
+    d->frames.clear();
+    d->lru.clear();
+    d->bytes = 0;
+}
+
+
+int FrameCache::count(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->frames.count();
+}
+
+
+qint64 FrameCache::bytes(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->bytes;
+}
+
+
+int FrameCache::hits(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->hits;
+}
+
+
+int FrameCache::misses(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->misses;
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMECACHE_H_
+#define __FRAMECACHE_H_
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+#include "videoframe.h"
+
+
+class FrameCachePrivate;
+
+// Least recently used set of converted frames, keyed by their presentation
+// time in milliseconds and bounded by the number of bytes the frames occupy.
+// Frames are copied on insertion. May be accessed from any thread.
+class FrameCache
+{
+public:
+    static const qint64 DefaultBudget = Q_INT64_C(256) * 1024 * 1024;
+
+    explicit FrameCache(qint64 budget = DefaultBudget);
+    ~FrameCache();
+
+    void setBudget(qint64 bytes);
+    qint64 budget(void) const;
+    void insert(const VideoFrame &frame);
+    bool lookup(qint64 ms, qint64 frameDurationMs, VideoFrame &frame);
+    bool contains(qint64 pts) const;
+    void clear(void);
+
+    int count(void) const;
+    qint64 bytes(void) const;
+    int hits(void) const;
+    int misses(void) const;
+
+private:
+    QScopedPointer<FrameCachePrivate> d_ptr;
+    Q_DECLARE_PRIVATE(FrameCache)
+    Q_DISABLE_COPY(FrameCache)
+
+};
+
+#endif // __FRAMECACHE_H_
@@ -0,0 +1,163 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QVector>
+#include <QRect>
+#include <qmath.h>
+#include <cstring>
+
+#include "framecompositor.h"
+#include "framepool.h"
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+
+class FrameCompositorPrivate {
+public:
+    FrameCompositorPrivate(void)
+        : pool(4)
+    { /* ... */ }
+    ~FrameCompositorPrivate()
+    {
+        foreach (SwsContext *ctx, scalers)
+            sws_freeContext(ctx);
+    }
+    static AVPixelFormat avPixelFormat(VideoFrame::PixelFormat pixelFormat)
+    {
+        switch (pixelFormat) {
+        case VideoFrame::Format_YUV420P:
+            return AV_PIX_FMT_YUV420P;
+        case VideoFrame::Format_RGB32:
+        case VideoFrame::Format_ARGB32:
+        case VideoFrame::Format_ARGB32_Premultiplied:
+            return AV_PIX_FMT_RGB32;
+        default:
+            return AV_PIX_FMT_NONE;
+        }
+    }
+    // Largest rectangle with the aspect ratio of `size` centred in `tile`.
+    static QRect fit(const QSize &size, const QRect &tile)
+    {
+        const QSize &scaled = size.scaled(tile.size(), Qt::KeepAspectRatio);
+        const int w = qMax(2, scaled.width() & ~1);
+        const int h = qMax(2, scaled.height() & ~1);
+        return QRect(tile.x() + (tile.width() - w) / 2, tile.y() + (tile.height() - h) / 2, w, h);
+    }
+    static void fillBlack(VideoFrame &canvas, const QRect &r)
+    {
+        for (int y = r.top(); y <= r.bottom(); ++y)
+            memset(canvas.bits(0) + y * canvas.bytesPerLine(0) + 4 * r.x(), 0, size_t(4 * r.width()));
+    }
+    QVector<VideoFrame> latest;
+    // one scaler per stream, the streams' sizes usually differ
+    QVector<SwsContext *> scalers;
+    QSize tileSize;
+    FramePool pool;
+};
+
+
+FrameCompositor::FrameCompositor(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new FrameCompositorPrivate)
+{
+    // ...
+}
+
+
+FrameCompositor::~FrameCompositor()
+{
+    // ...
+}
+
+
+void FrameCompositor::setStreamCount(int n)
+{
+    Q_D(FrameCompositor);
+    d->latest.clear();
+    d->latest.resize(n);
+    while (d->scalers.count() > n)
+        sws_freeContext(d->scalers.takeLast());
+    d->scalers.resize(n);
+}
+
+
+int FrameCompositor::streamCount(void) const
+{
+    return d_ptr->latest.count();
+}
+
+
+void FrameCompositor::setTileSize(const QSize &size)
+{
+    Q_D(FrameCompositor);
+    d->tileSize = size;
+}
+
+
+QSize FrameCompositor::tileSize(void) const
+{
+    return d_ptr->tileSize;
+}
+
+
+void FrameCompositor::setFrame(int stream, const VideoFrame &frame)
+{
+    Q_D(FrameCompositor);
+    if (stream < 0 || stream >= d->latest.count())
+        return;
+    d->latest[stream] = frame;
+    if (stream == 0)
+        compose();
+}
+
+
+void FrameCompositor::compose(void)
+{
+    Q_D(FrameCompositor);
+    const int n = d->latest.count();
+    if (n == 0)
+        return;
+    const QSize &tile = d->tileSize.isValid() ? d->tileSize : d->latest.first().size();
+    if (tile.isEmpty())
+        return;
+    const int cols = qCeil(qSqrt(n));
+    const int rows = (n + cols - 1) / cols;
+    VideoFrame canvas(QSize(cols * tile.width(), rows * tile.height()), VideoFrame::Format_RGB32, &d->pool);
+    canvas.pts = d->latest.first().pts;
+    canvas.number = d->latest.first().number;
+    for (int i = 0; i < cols * rows; ++i) {
+        const QRect tileRect(QPoint((i % cols) * tile.width(), (i / cols) * tile.height()), tile);
+        const VideoFrame &src = (i < n) ? d->latest.at(i) : VideoFrame();
+        const AVPixelFormat srcFmt = FrameCompositorPrivate::avPixelFormat(src.pixelFormat());
+        if (src.isNull() || srcFmt == AV_PIX_FMT_NONE) {
+            FrameCompositorPrivate::fillBlack(canvas, tileRect);
+            continue;
+        }
+        const QRect &r = FrameCompositorPrivate::fit(src.size(), tileRect);
+        if (r != tileRect)
+            FrameCompositorPrivate::fillBlack(canvas, tileRect);
+        d->scalers[i] = sws_getCachedContext(d->scalers.at(i),
+                                             src.size().width(), src.size().height(), srcFmt,
+                                             r.width(), r.height(), AV_PIX_FMT_RGB32,
+                                             SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        if (d->scalers.at(i) == nullptr) {
+            FrameCompositorPrivate::fillBlack(canvas, tileRect);
+            continue;
+        }
+        if (!src.isRGB()) {
+            const int *coefficients = sws_getCoefficients(src.colorMatrix == VideoFrame::BT709 ? SWS_CS_ITU709 : SWS_CS_ITU601);
+            sws_setColorspaceDetails(d->scalers.at(i), coefficients, src.colorRange == VideoFrame::FullRange,
+                                     coefficients, 1, 0, 1 << 16, 1 << 16);
+        }
+        const uint8_t *srcData[4] = { src.bits(0), src.bits(1), src.bits(2), nullptr };
+        const int srcLinesize[4] = { src.bytesPerLine(0), src.bytesPerLine(1), src.bytesPerLine(2), 0 };
+        uint8_t *dstData[4] = { canvas.bits(0) + r.y() * canvas.bytesPerLine(0) + 4 * r.x(), nullptr, nullptr, nullptr };
+        const int dstLinesize[4] = { canvas.bytesPerLine(0), 0, 0, 0 };
+        sws_scale(d->scalers.at(i), srcData, srcLinesize, 0, src.size().height(), dstData, dstLinesize);
+    }
+    emit frameReady(canvas);
+}
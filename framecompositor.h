@@ -0,0 +1,48 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMECOMPOSITOR_H_
+#define __FRAMECOMPOSITOR_H_
+
+#include <QObject>
+#include <QSize>
+#include <QScopedPointer>
+
+#include "videoframe.h"
+
+
+class FrameCompositorPrivate;
+
+// Lays out the latest frames of several streams in a grid on one RGB32
+// frame, each scaled to fit its tile with the aspect ratio kept. A new
+// composite is produced whenever stream 0 delivers a frame.
+class FrameCompositor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameCompositor(QObject *parent = nullptr);
+    ~FrameCompositor();
+
+    void setStreamCount(int n);
+    int streamCount(void) const;
+    // An invalid size makes the tiles as large as stream 0's frames.
+    void setTileSize(const QSize &);
+    QSize tileSize(void) const;
+
+signals:
+    void frameReady(const VideoFrame &);
+
+public slots:
+    void setFrame(int stream, const VideoFrame &);
+
+private: // methods
+    void compose(void);
+
+private:
+    QScopedPointer<FrameCompositorPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(FrameCompositor)
+    Q_DISABLE_COPY(FrameCompositor)
+
+};
+
+#endif // __FRAMECOMPOSITOR_H_
@@ -0,0 +1,194 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QWeakPointer>
+
+#include "framepool.h"
+
+
+class FramePoolPrivate {
+public:
+    explicit FramePoolPrivate(int capacity)
+        : capacity(capacity)
+        , bufferSize(0)
+        , inUse(0)
+        , highWaterMark(0)
+        , allocationMisses(0)
+    { /* ... */ }
+    ~FramePoolPrivate()
+    {
+        clear();
+    }
+    void clear(void)
+    {
+        foreach (FrameBuffer *buf, freeBuffers) {
+            qFreeAligned(buf->data);
+            delete buf;
+        }
+        freeBuffers.clear();
+    }
+    static FrameBuffer *newBuffer(int size)
+    {
+        uchar *data = reinterpret_cast<uchar *>(qMallocAligned(size_t(size), FramePool::Alignment));
+        if (data == nullptr)
+            qFatal("Out of memory error.");
+        return new FrameBuffer(data, size);
+    }
+    void recycle(FrameBuffer *buf)
+    {
+        QMutexLocker locker(&mtx);
+        --inUse;
+        if (buf->size == bufferSize && freeBuffers.count() < capacity) {
+            freeBuffers.append(buf);
+        }
+        else {
+            qFreeAligned(buf->data);
+            delete buf;
+        }
+    }
+    QMutex mtx;
+    QVector<FrameBuffer *> freeBuffers;
+    int capacity;
+    int bufferSize;
+    int inUse;
+    int highWaterMark;
+    int allocationMisses;
+};
+
+
+// Hands a buffer back to its pool when the last reference to it is dropped.
+// If the pool is already gone the buffer is simply freed.
+class FrameBufferRecycler {
+public:
+    explicit FrameBufferRecycler(const QSharedPointer<FramePoolPrivate> &pool)
+        : pool(pool)
+    { /* ... */ }
+    void operator()(FrameBuffer *buf) const
+    {
+        QSharedPointer<FramePoolPrivate> p = pool.toStrongRef();
+        if (p.isNull()) {
+            qFreeAligned(buf->data);
+            delete buf;
+        }
+        else {
+            p->recycle(buf);
+        }
+    }
+private:
+    QWeakPointer<FramePoolPrivate> pool;
+};
+
+
+static void freeFrameBuffer(FrameBuffer *buf)
+{
+    qFreeAligned(buf->data);
+    delete buf;
+}
+
+
+FramePool::FramePool(int capacity)
+    : d_ptr(new FramePoolPrivate(capacity))
+{
+    // ...
+}
+
+
+FramePool::~FramePool()
+{
+    qDebug() << "FramePool: high-water mark =" << highWaterMark() << "allocation misses =" << allocationMisses();
+}
+
+
+void FramePool::setCapacity(int capacity)
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    d_ptr->capacity = capacity;
+    while (d_ptr->freeBuffers.count() > capacity) {
+        FrameBuffer *buf = d_ptr->freeBuffers.takeLast();
+        qFreeAligned(buf->data);
+        delete buf;
+    }
+}
+
+
+void FramePool::reserve(int bufferSize)
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    if (bufferSize != d_ptr->bufferSize) {
+        d_ptr->clear();
+        d_ptr->bufferSize = bufferSize;
+    }
+    while (d_ptr->freeBuffers.count() + d_ptr->inUse < d_ptr->capacity)
+        d_ptr->freeBuffers.append(FramePoolPrivate::newBuffer(bufferSize));
+}
+
+
+FrameBufferPtr FramePool::acquire(int size)
+{
+    if (size != bufferSize())
+        reserve(size);
+    QMutexLocker locker(&d_ptr->mtx);
+    FrameBuffer *buf;
+    if (d_ptr->freeBuffers.isEmpty()) {
+        buf = FramePoolPrivate::newBuffer(size);
+        ++d_ptr->allocationMisses;
+    }
+    else {
+        buf = d_ptr->freeBuffers.takeLast();
+    }
+    ++d_ptr->inUse;
+    if (d_ptr->inUse > d_ptr->highWaterMark)
+        d_ptr->highWaterMark = d_ptr->inUse;
+    return FrameBufferPtr(buf, FrameBufferRecycler(d_ptr));
+}
+
+
+FrameBufferPtr FramePool::allocate(int size)
+{
+    return FrameBufferPtr(FramePoolPrivate::newBuffer(size), freeFrameBuffer);
+}
+
+
+int FramePool::capacity(void) const
+{
+    return d_ptr->capacity;
+}
+
+
+int FramePool::bufferSize(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->bufferSize;
+}
+
+
+int FramePool::available(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->freeBuffers.count();
+}
+
+
+int FramePool::inUse(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->inUse;
+}
+
+
+int FramePool::highWaterMark(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->highWaterMark;
+}
+
+
+int FramePool::allocationMisses(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->allocationMisses;
+}
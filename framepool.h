@@ -0,0 +1,53 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMEPOOL_H_
+#define __FRAMEPOOL_H_
+
+#include <QSharedPointer>
+#include <QtGlobal>
+
+
+class FrameBuffer {
+public:
+    FrameBuffer(uchar *data, int size)
+        : data(data)
+        , size(size)
+    { /* ... */ }
+    uchar *data;
+    int size;
+};
+
+typedef QSharedPointer<FrameBuffer> FrameBufferPtr;
+
+
+class FramePoolPrivate;
+
+class FramePool
+{
+public:
+    static const int Alignment = 64;
+
+    explicit FramePool(int capacity);
+    ~FramePool();
+
+    void setCapacity(int capacity);
+    void reserve(int bufferSize);
+    FrameBufferPtr acquire(int size);
+
+    int capacity(void) const;
+    int bufferSize(void) const;
+    int available(void) const;
+    int inUse(void) const;
+    int highWaterMark(void) const;
+    int allocationMisses(void) const;
+
+    static FrameBufferPtr allocate(int size);
+
+private:
+    QSharedPointer<FramePoolPrivate> d_ptr;
+    Q_DISABLE_COPY(FramePool)
+
+};
+
+#endif // __FRAMEPOOL_H_
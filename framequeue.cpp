@@ -0,0 +1,216 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#include "framequeue.h"
+
+
+class FrameQueuePrivate {
+public:
+    explicit FrameQueuePrivate(int capacity)
+        : ring(new VideoFrame[capacity + 1])
+        , size(capacity + 1)
+        , head(0)
+        , tail(0)
+        , cancelled(0)
+        , producerWaiting(0)
+        , highWaterMark(0)
+        , stalls(0)
+        , drops(0)
+    { /* ... */ }
+    ~FrameQueuePrivate()
+    {
+        delete [] ring;
+    }
+    // one entry always stays empty to tell a full queue from an empty one
+    VideoFrame *ring;
+    int size;
+    QAtomicInt head; // written by consumer only
+    QAtomicInt tail; // written by producer only
+    QAtomicInt cancelled;
+    QAtomicInt producerWaiting;
+    QAtomicInt highWaterMark;
+    QAtomicInt stalls;
+    QAtomicInt drops;
+    QMutex mtx;
+    QWaitCondition notFull;
+
+    inline int next(int idx) const
+    {
+        return (idx + 1) % size;
+    }
+    inline int count(void) const
+    {
+        const int n = tail.loadAcquire() - head.loadAcquire();
+        return n < 0 ? n + size : n;
+    }
+    bool enqueue(const VideoFrame &frame)
+    {
+        const int t = tail.load();
+        if (next(t) == head.loadAcquire())
+            return false;
+        ring[t] = frame;
+        tail.storeRelease(next(t));
+        const int n = count();
+        if (n > highWaterMark.load())
+            highWaterMark.store(n);
+        return true;
+    }
+};
+
+
+FrameQueue::FrameQueue(int capacity)
+    : d_ptr(new FrameQueuePrivate(capacity))
+{
+    Q_ASSERT(capacity > 0);
+}
+
+
+FrameQueue::~FrameQueue()
+{
+    qDebug() << "FrameQueue: high-water mark =" << highWaterMark() << "stalls =" << stalls() << "drops =" << drops();
+}
+
+
+// Must only be called while neither producer nor consumer are active.
+void FrameQueue::setCapacity(int capacity)
+{
+    Q_D(FrameQueue);
+    Q_ASSERT(capacity > 0);
+    delete [] d->ring;
+    d->ring = new VideoFrame[capacity + 1];
+    d->size = capacity + 1;
+    d->head.store(0);
+    d->tail.store(0);
+}
+
+
+int FrameQueue::capacity(void) const
+{
+    return d_ptr->size - 1;
+}
+
+
+// Blocks while the queue is full. Returns false if the queue was cancelled.
+bool FrameQueue::push(const VideoFrame &frame)
+{
+    Q_D(FrameQueue);
+    if (d->cancelled.load())
+        return false;
+    if (d->enqueue(frame))
+        return true;
+    d->stalls.fetchAndAddRelaxed(1);
+    QMutexLocker locker(&d->mtx);
+    d->producerWaiting.store(1);
+    while (!d->enqueue(frame)) {
+        if (d->cancelled.load()) {
+            d->producerWaiting.store(0);
+            return false;
+        }
+        // time out regularly in case a wake-up slipped in between the check and the wait
+        d->notFull.wait(&d->mtx, 10);
+    }
+    d->producerWaiting.store(0);
+    return true;
+}
+
+
+// Returns immediately. If the queue is full the frame is dropped.
+bool FrameQueue::tryPush(const VideoFrame &frame)
+{
+    Q_D(FrameQueue);
+    if (d->cancelled.load())
+        return false;
+    if (d->enqueue(frame))
+        return true;
+    d->drops.fetchAndAddRelaxed(1);
+    return false;
+}
+
+
+bool FrameQueue::tryPop(VideoFrame &frame)
+{
+    Q_D(FrameQueue);
+    const int h = d->head.load();
+    if (h == d->tail.loadAcquire())
+        return false;
+    frame = d->ring[h];
+    // release the entry's reference so that the frame buffer can go back to the pool as soon as possible
+    d->ring[h] = VideoFrame();
+    d->head.storeRelease(d->next(h));
+    if (d->producerWaiting.load()) {
+        QMutexLocker locker(&d->mtx);
+        d->notFull.wakeAll();
+    }
+    return true;
+}
+
+
+// Copies the oldest frame without taking it off the queue. Consumer only.
+bool FrameQueue::peek(VideoFrame &frame) const
+{
+    const int h = d_ptr->head.load();
+    if (h == d_ptr->tail.loadAcquire())
+        return false;
+    frame = d_ptr->ring[h];
+    return true;
+}
+
+
+void FrameQueue::cancel(void)
+{
+    Q_D(FrameQueue);
+    d->cancelled.store(1);
+    QMutexLocker locker(&d->mtx);
+    d->notFull.wakeAll();
+}
+
+
+void FrameQueue::resume(void)
+{
+    d_ptr->cancelled.store(0);
+}
+
+
+// Must be called from the consumer's thread while the producer is stopped.
+void FrameQueue::clear(void)
+{
+    VideoFrame frame;
+    while (tryPop(frame))
+        /* discard */;
+}
+
+
+bool FrameQueue::isCancelled(void) const
+{
+    return d_ptr->cancelled.load() != 0;
+}
+
+
+int FrameQueue::count(void) const
+{
+    return d_ptr->count();
+}
+
+
+int FrameQueue::highWaterMark(void) const
+{
+    return d_ptr->highWaterMark.load();
+}
+
+
+int FrameQueue::stalls(void) const
+{
+    return d_ptr->stalls.load();
+}
+
+
+int FrameQueue::drops(void) const
+{
+    return d_ptr->drops.load();
+}
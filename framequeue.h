@@ -0,0 +1,49 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMEQUEUE_H_
+#define __FRAMEQUEUE_H_
+
+#include <QScopedPointer>
+
+#include "videoframe.h"
+
+
+class FrameQueuePrivate;
+
+// Bounded single-producer/single-consumer ring buffer for decoded frames.
+// push() and tryPop() don't take any locks; a mutex is only involved
+// when the producer has to sleep because the queue is full.
+class FrameQueue
+{
+public:
+    static const int DefaultCapacity = 64;
+
+    explicit FrameQueue(int capacity = DefaultCapacity);
+    ~FrameQueue();
+
+    void setCapacity(int capacity);
+    int capacity(void) const;
+
+    bool push(const VideoFrame &);
+    bool tryPush(const VideoFrame &);
+    bool tryPop(VideoFrame &);
+    bool peek(VideoFrame &) const;
+    void cancel(void);
+    void resume(void);
+    void clear(void);
+    bool isCancelled(void) const;
+
+    int count(void) const;
+    int highWaterMark(void) const;
+    int stalls(void) const;
+    int drops(void) const;
+
+private:
+    QScopedPointer<FrameQueuePrivate> d_ptr;
+    Q_DECLARE_PRIVATE(FrameQueue)
+    Q_DISABLE_COPY(FrameQueue)
+
+};
+
+#endif // __FRAMEQUEUE_H_
@@ -0,0 +1,116 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "framescheduler.h"
+
+
+class FrameSchedulerPrivate {
+public:
+    FrameSchedulerPrivate(FrameQueue *frameQueue, PresentationClock *clock)
+        : frameQueue(frameQueue)
+        , clock(clock)
+        , presentedFrames(0)
+        , statsFrames(0)
+        , sumAbsUs(0)
+        , maxEarlyUs(0)
+        , maxLateUs(0)
+    { /* ... */ }
+    FrameQueue *frameQueue;
+    PresentationClock *clock;
+    QTimer timer;
+    int presentedFrames;
+    // deviation statistics, reset every second
+    QElapsedTimer statsTimer;
+    int statsFrames;
+    qint64 sumAbsUs;
+    qint64 maxEarlyUs;
+    qint64 maxLateUs;
+    // wake up a little early, timers tend to fire late rather than early
+    static const int TimerSlackUs = 1000;
+};
+
+
+FrameScheduler::FrameScheduler(FrameQueue *frameQueue, PresentationClock *clock, QObject *parent)
+    : QObject(parent)
+    , d_ptr(new FrameSchedulerPrivate(frameQueue, clock))
+{
+    Q_D(FrameScheduler);
+    d->timer.setSingleShot(true);
+    d->timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&d->timer, SIGNAL(timeout()), SLOT(schedule()));
+    d->statsTimer.start();
+}
+
+
+FrameScheduler::~FrameScheduler()
+{
+    qDebug() << "FrameScheduler: presented frames =" << presentedFrames();
+}
+
+
+// Switches over to another decoder's queue and clock. A frame waiting for
+// its time on the previous clock is forgotten.
+void FrameScheduler::setSource(FrameQueue *frameQueue, PresentationClock *clock)
+{
+    Q_D(FrameScheduler);
+    d->timer.stop();
+    d->frameQueue = frameQueue;
+    d->clock = clock;
+}
+
+
+int FrameScheduler::presentedFrames(void) const
+{
+    return d_ptr->presentedFrames;
+}
+
+
+// Presents all frames that are due and arms the timer for the next one.
+// The first frame after a seek, and every frame while the clock is
+// paused, is shown right away and the clock is synced to it.
+void FrameScheduler::schedule(void)
+{
+    Q_D(FrameScheduler);
+    VideoFrame frame;
+    while (d->frameQueue->peek(frame)) {
+        if (!d->clock->isValid() || d->clock->isPaused()) {
+            d->clock->sync(frame.pts);
+            d->frameQueue->tryPop(frame);
+            present(frame, 0);
+            continue;
+        }
+        const qint64 waitUs = d->clock->usecsUntil(frame.pts);
+        if (waitUs > FrameSchedulerPrivate::TimerSlackUs) {
+            d->timer.start(int((waitUs - FrameSchedulerPrivate::TimerSlackUs) / 1000));
+            return;
+        }
+        d->frameQueue->tryPop(frame);
+        present(frame, -waitUs);
+    }
+}
+
+
+// `deviationUs` is positive if the frame is shown late, negative if early.
+void FrameScheduler::present(const VideoFrame &frame, qint64 deviationUs)
+{
+    Q_D(FrameScheduler);
+    ++d->presentedFrames;
+    ++d->statsFrames;
+    d->sumAbsUs += qAbs(deviationUs);
+    d->maxEarlyUs = qMax(d->maxEarlyUs, -deviationUs);
+    d->maxLateUs = qMax(d->maxLateUs, deviationUs);
+    emit frameReady(frame);
+    emit framePresented(frame.pts, deviationUs);
+    if (d->statsTimer.elapsed() > 1000) {
+        emit deviationChanged(1e-3 * d->sumAbsUs / d->statsFrames, 1e-3 * d->maxEarlyUs, 1e-3 * d->maxLateUs);
+        d->statsFrames = 0;
+        d->sumAbsUs = 0;
+        d->maxEarlyUs = 0;
+        d->maxLateUs = 0;
+        d->statsTimer.restart();
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FRAMESCHEDULER_H_
+#define __FRAMESCHEDULER_H_
+
+#include <QObject>
+#include <QScopedPointer>
+
+#include "videoframe.h"
+#include "framequeue.h"
+#include "presentationclock.h"
+
+
+class FrameSchedulerPrivate;
+
+// Takes frames off the decoder's frame queue when the presentation clock
+// reaches their timestamp. Lives in the consumer's (i.e. the GUI) thread.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameScheduler(FrameQueue *frameQueue, PresentationClock *clock, QObject *parent = nullptr);
+    ~FrameScheduler();
+
+    void setSource(FrameQueue *frameQueue, PresentationClock *clock);
+    int presentedFrames(void) const;
+
+signals:
+    void frameReady(const VideoFrame &);
+    void framePresented(qint64 pts, qint64 deviationUs);
+    void deviationChanged(qreal meanAbsMs, qreal maxEarlyMs, qreal maxLateMs);
+
+public slots:
+    void schedule(void);
+
+private: // methods
+    void present(const VideoFrame &, qint64 deviationUs);
+
+private:
+    QScopedPointer<FrameSchedulerPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(FrameScheduler)
+    Q_DISABLE_COPY(FrameScheduler)
+
+};
+
+#endif // __FRAMESCHEDULER_H_
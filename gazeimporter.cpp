@@ -0,0 +1,601 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QByteArray>
+#include <qmath.h>
+#include <cstring>
+
+#include "gazeimporter.h"
+#include "util.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMPORT_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+
+namespace {
+
+#ifdef IMPORT_SSE2
+inline int lowestBit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, ulong(mask));
+    return int(index);
+#else
+    return __builtin_ctz(uint(mask));
+#endif
+}
+#endif
+
+
+// First occurrence of `c` in [p, end), or `end`. Compares 16 bytes at a time where SSE2 is available.
+inline const char *findByte(const char *p, const char *end, char c)
+{
+#ifdef IMPORT_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), needle));
+        if (mask != 0)
+            return p + lowestBit(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != c)
+        ++p;
+    return p;
+}
+
+
+inline const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+
+inline bool isDigit(char c)
+{
+    return uint(c - '0') < 10;
+}
+
+
+// powers of ten a double holds exactly, so mantissa * 10^e rounds only once
+const double Pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22
+};
+
+
+// Parses a decimal number like "-12.5e-3" at `p` and moves `p` behind it.
+// With `decimalComma` set "12,5" is accepted as well, as written by
+// software that follows a German locale.
+bool parseNumber(const char *&p, const char *end, bool decimalComma, double &value)
+{
+    const char *s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+        negative = *s == '-';
+        ++s;
+    }
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; s < end && isDigit(*s); ++s) {
+        any = true;
+        if (digits < 19) {
+            mantissa = 10 * mantissa + quint64(*s - '0');
+            if (mantissa != 0)
+                ++digits;
+        }
+        else {
+            ++exponent;
+        }
+    }
+    if (s < end && (*s == '.' || (decimalComma && *s == ','))) {
+        for (++s; s < end && isDigit(*s); ++s) {
+            any = true;
+            if (digits < 19) {
+                mantissa = 10 * mantissa + quint64(*s - '0');
+                if (mantissa != 0)
+                    ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!any)
+        return false;
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char *e = s + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        if (e == end || !isDigit(*e))
+            return false;
+        int x = 0;
+        for (; e < end && isDigit(*e); ++e) {
+            if (x < 10000)
+                x = 10 * x + (*e - '0');
+        }
+        exponent += negativeExponent ? -x : x;
+        s = e;
+    }
+    double v = double(mantissa);
+    if (exponent < 0)
+        v = exponent >= -22 ? v / Pow10[-exponent] : v * qPow(10.0, exponent);
+    else if (exponent > 0)
+        v = exponent <= 22 ? v * Pow10[exponent] : v * qPow(10.0, exponent);
+    value = negative ? -v : v;
+    p = s;
+    return true;
+}
+
+
+// where to find the values in a line
+struct Layout {
+    Layout(void)
+        : delimiter(';')
+        , timestampColumn(0)
+        , xColumn(1)
+        , yColumn(2)
+        , exactColumns(true)
+        , decimalComma(false)
+        , emptyMeansMissing(false)
+        , timestampScale(1.0)
+        , coordinateSpace(GazeLog::VideoRelative)
+    { /* ... */ }
+    char delimiter;
+    int timestampColumn;
+    int xColumn;
+    int yColumn;
+    // more columns than the three are an error
+    bool exactColumns;
+    bool decimalComma;
+    // an empty gaze point stands for a sample without gaze rather than an error
+    bool emptyMeansMissing;
+    // converts timestamps to milliseconds
+    double timestampScale;
+    GazeLog::CoordinateSpace coordinateSpace;
+};
+
+
+enum LineResult {
+    Parsed,
+    Malformed,
+    Missing
+};
+
+
+LineResult parseLine(const char *p, const char *eol, const Layout &layout, double &t, double &x, double &y)
+{
+    const int lastColumn = qMax(layout.timestampColumn, qMax(layout.xColumn, layout.yColumn));
+    bool haveT = false;
+    bool haveX = false;
+    bool haveY = false;
+    for (int col = 0; col <= lastColumn; ++col) {
+        const char *fieldEnd = findByte(p, eol, layout.delimiter);
+        if (fieldEnd == eol && col < lastColumn)
+            return Malformed;
+        double *value = col == layout.timestampColumn ? &t : col == layout.xColumn ? &x : col == layout.yColumn ? &y : nullptr;
+        if (value != nullptr) {
+            const char *s = skipSpace(p, fieldEnd);
+            if (s != fieldEnd) {
+                if (!parseNumber(s, fieldEnd, layout.decimalComma, *value) || skipSpace(s, fieldEnd) != fieldEnd)
+                    return Malformed;
+                (col == layout.timestampColumn ? haveT : col == layout.xColumn ? haveX : haveY) = true;
+            }
+        }
+        if (col == lastColumn && layout.exactColumns && fieldEnd != eol)
+            return Malformed;
+        p = fieldEnd + 1;
+    }
+    if (!haveT)
+        return Malformed;
+    if (haveX && haveY)
+        return Parsed;
+    return layout.emptyMeansMissing ? Missing : Malformed;
+}
+
+
+struct Chunk {
+    Chunk(void)
+        : begin(nullptr)
+        , end(nullptr)
+        , lines(0)
+        , malformed(0)
+        , firstMalformed(-1)
+        , missing(0)
+    { /* ... */ }
+    const char *begin;
+    const char *end;
+    GazeColumns columns;
+    qint64 lines;
+    qint64 malformed;
+    // line number within the chunk, counting from 0
+    qint64 firstMalformed;
+    qint64 missing;
+};
+
+
+class ChunkParser : public QRunnable {
+public:
+    ChunkParser(Chunk *chunk, const Layout &layout)
+        : chunk(chunk)
+        , layout(layout)
+    { /* ... */ }
+    void run(void)
+    {
+        // "t;x;y" lines are at least 6 bytes long, most are around 20
+        const int estimate = int((chunk->end - chunk->begin) / 16);
+        chunk->columns.timestamps.reserve(estimate);
+        chunk->columns.x.reserve(estimate);
+        chunk->columns.y.reserve(estimate);
+        const char *p = chunk->begin;
+        while (p < chunk->end) {
+            const char *eol = findByte(p, chunk->end, '\n');
+            const char *next = eol < chunk->end ? eol + 1 : chunk->end;
+            if (skipSpace(p, eol) != eol) {
+                double t, x, y;
+                switch (parseLine(p, eol, layout, t, x, y)) {
+                case Parsed:
+                    chunk->columns.timestamps.append(qRound64(t * layout.timestampScale));
+                    chunk->columns.x.append(x);
+                    chunk->columns.y.append(y);
+                    break;
+                case Missing:
+                    ++chunk->missing;
+                    break;
+                case Malformed:
+                    if (chunk->firstMalformed < 0)
+                        chunk->firstMalformed = chunk->lines;
+                    ++chunk->malformed;
+                    break;
+                }
+            }
+            ++chunk->lines;
+            p = next;
+        }
+    }
+
+private:
+    Chunk *chunk;
+    const Layout &layout;
+};
+
+
+// Finds the columns in the header line of a Tobii export. Column names
+// vary between versions ("GazePointX (ADCSpx)", "Gaze point X", ...), so
+// they are compared with spaces removed and case ignored. The names also
+// tell the units: eye tracker timestamps and those marked [us] are in
+// microseconds, others in milliseconds; gaze points are in pixels of the
+// screen (ADCS) unless marked as media (MCS) or normalised.
+bool parseTobiiHeader(const QByteArray &header, Layout &layout)
+{
+    const QList<QByteArray> &names = header.split('\t');
+    layout.timestampColumn = layout.xColumn = layout.yColumn = -1;
+    for (int i = 0; i < names.count(); ++i) {
+        const QByteArray &name = names.at(i).toLower().replace(" ", "").trimmed();
+        if (layout.timestampColumn < 0 && name.contains("timestamp")) {
+            layout.timestampColumn = i;
+            const bool micro = name.startsWith("eyetrackertimestamp") || name.contains("[us]") || name.contains("[\xce\xbcs]");
+            layout.timestampScale = micro ? 1e-3 : 1.0;
+        }
+        else if (layout.xColumn < 0 && name.startsWith("gazepointx")) {
+            layout.xColumn = i;
+            layout.coordinateSpace = name.contains("norm")
+                    ? GazeLog::VideoRelative
+                    : name.contains("mcs") ? GazeLog::MediaPixels : GazeLog::ScreenPixels;
+        }
+        else if (layout.yColumn < 0 && name.startsWith("gazepointy")) {
+            layout.yColumn = i;
+        }
+    }
+    layout.delimiter = '\t';
+    layout.exactColumns = false;
+    layout.decimalComma = true;
+    layout.emptyMeansMissing = true;
+    return layout.timestampColumn >= 0 && layout.xColumn >= 0 && layout.yColumn >= 0;
+}
+
+
+// A part of the file, mapped if possible and read otherwise.
+class Window {
+public:
+    explicit Window(QFile &file)
+        : begin(nullptr)
+        , end(nullptr)
+        , file(file)
+        , map(nullptr)
+    { /* ... */ }
+    ~Window()
+    {
+        if (map != nullptr)
+            file.unmap(map);
+    }
+    bool open(qint64 offset, qint64 size)
+    {
+        map = file.map(offset, size);
+        if (map != nullptr) {
+            begin = reinterpret_cast<const char *>(map);
+        }
+        else {
+            data.resize(int(size));
+            if (!file.seek(offset) || file.read(data.data(), size) != size)
+                return false;
+            begin = data.constData();
+        }
+        end = begin + size;
+        return true;
+    }
+    const char *begin;
+    const char *end;
+private:
+    QFile &file;
+    uchar *map;
+    QByteArray data;
+};
+
+}
+
+
+class GazeImporterPrivate {
+public:
+    GazeImporterPrivate(void)
+        : threadCount(0)
+        , format(GazeImporter::UnknownFormat)
+        , coordinateSpace(GazeLog::VideoRelative)
+        , lines(0)
+        , malformed(0)
+        , firstMalformed(-1)
+        , missing(0)
+        , bytes(0)
+        , elapsedMs(0)
+    { /* ... */ }
+    void reset(void)
+    {
+        columns.clear();
+        format = GazeImporter::UnknownFormat;
+        coordinateSpace = GazeLog::VideoRelative;
+        lines = 0;
+        malformed = 0;
+        firstMalformed = -1;
+        missing = 0;
+        bytes = 0;
+        elapsedMs = 0;
+    }
+    bool parse(const char *begin, const char *end, const Layout &layout);
+    int threadCount;
+    GazeColumns columns;
+    GazeImporter::Format format;
+    GazeLog::CoordinateSpace coordinateSpace;
+    qint64 lines;
+    qint64 malformed;
+    qint64 firstMalformed;
+    qint64 missing;
+    qint64 bytes;
+    qint64 elapsedMs;
+};
+
+
+GazeImporter::GazeImporter(void)
+    : d_ptr(new GazeImporterPrivate)
+{
+    // ...
+}
+
+
+GazeImporter::~GazeImporter()
+{
+    // ...
+}
+
+
+void GazeImporter::setThreadCount(int n)
+{
+    Q_D(GazeImporter);
+    d->threadCount = qMax(0, n);
+}
+
+
+int GazeImporter::threadCount(void) const
+{
+    return d_ptr->threadCount;
+}
+
+
+bool GazeImporter::import(const QString &filename)
+{
+    Q_D(GazeImporter);
+    d->reset();
+    QElapsedTimer timer;
+    timer.start();
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    d->bytes = f.size();
+    if (d->bytes == 0) {
+        d->format = SemicolonSeparated;
+        return true;
+    }
+    Layout layout;
+    qint64 offset = 0;
+    while (offset < d->bytes) {
+        Window window(f);
+        if (!window.open(offset, qMin(qint64(WindowSize), d->bytes - offset))) {
+            qWarning() << "GazeImporter: cannot read" << filename;
+            return false;
+        }
+        const char *begin = window.begin;
+        const char *end = window.end;
+        if (offset + (end - begin) < d->bytes) {
+            // the window ends behind its last complete line, the rest comes with the next one
+            const char *cut = end;
+            while (cut > begin && cut[-1] != '\n')
+                --cut;
+            // a line longer than the window is split
+            if (cut > begin)
+                end = cut;
+        }
+        offset += end - begin;
+        if (d->format == UnknownFormat) {
+            // the first line tells the format
+            const char *eol = findByte(begin, end, '\n');
+            const QByteArray firstLine(begin, int(eol - begin));
+            bool header = false;
+            if (firstLine.contains('\t')) {
+                if (!parseTobiiHeader(firstLine, layout)) {
+                    qWarning() << "GazeImporter: no timestamp and gaze point columns in" << filename;
+                    return false;
+                }
+                d->format = TobiiTsv;
+                header = true;
+            }
+            else {
+                d->format = SemicolonSeparated;
+                const char *s = skipSpace(begin, eol);
+                header = s < eol && !isDigit(*s) && *s != '-' && *s != '+';
+            }
+            d->coordinateSpace = layout.coordinateSpace;
+            if (header) {
+                begin = eol < end ? eol + 1 : end;
+                d->lines = 1;
+            }
+        }
+        if (!d->parse(begin, end, layout)) {
+            qWarning() << "GazeImporter: too many samples in" << filename;
+            d->columns.clear();
+            return false;
+        }
+    }
+    d->elapsedMs = timer.elapsed();
+    qDebug() << "GazeImporter:" << d->columns.count() << "samples from" << d->lines << "lines of" << filename
+             << "in" << d->elapsedMs << "ms,"
+             << 1e3 * d->bytes / qMax(Q_INT64_C(1), d->elapsedMs) / 1024 / 1024 << "MB/s;"
+             << "malformed:" << d->malformed << "missing:" << d->missing;
+    return true;
+}
+
+
+// Parses the lines in [begin, end) in parallel and appends the samples.
+// Returns false if they don't fit into the columns.
+bool GazeImporterPrivate::parse(const char *begin, const char *end, const Layout &layout)
+{
+    // chunks end right behind a newline, so no line is split between two of them
+    const int n = qMax(1, qMin(threadCount > 0 ? threadCount : QThread::idealThreadCount(),
+                               int((end - begin) / (1024 * 1024)) + 1));
+    QVector<Chunk> chunks(n);
+    const char *p = begin;
+    for (int i = 0; i < n; ++i) {
+        const char *split = (i == n - 1) ? end : begin + (end - begin) * (i + 1) / n;
+        if (split < p)
+            split = p;
+        if (split < end) {
+            split = findByte(split, end, '\n');
+            if (split < end)
+                ++split;
+        }
+        chunks[i].begin = p;
+        chunks[i].end = split;
+        p = split;
+    }
+    QThreadPool pool;
+    pool.setMaxThreadCount(n);
+    for (int i = 0; i < n; ++i)
+        pool.start(new ChunkParser(&chunks[i], layout));
+    pool.waitForDone();
+
+    qint64 total = columns.count();
+    foreach (const Chunk &chunk, chunks)
+        total += chunk.columns.count();
+    if (total > maxVectorCount<qint64>())
+        return false;
+    int offset = columns.count();
+    columns.timestamps.resize(int(total));
+    columns.x.resize(int(total));
+    columns.y.resize(int(total));
+    foreach (const Chunk &chunk, chunks) {
+        const int count = chunk.columns.count();
+        memcpy(columns.timestamps.data() + offset, chunk.columns.timestamps.constData(), count * sizeof(qint64));
+        memcpy(columns.x.data() + offset, chunk.columns.x.constData(), count * sizeof(double));
+        memcpy(columns.y.data() + offset, chunk.columns.y.constData(), count * sizeof(double));
+        offset += count;
+        if (firstMalformed < 0 && chunk.firstMalformed >= 0)
+            firstMalformed = lines + chunk.firstMalformed + 1;
+        lines += chunk.lines;
+        malformed += chunk.malformed;
+        missing += chunk.missing;
+    }
+    return true;
+}
+
+
+const GazeColumns &GazeImporter::columns(void) const
+{
+    return d_ptr->columns;
+}
+
+
+GazeImporter::Format GazeImporter::format(void) const
+{
+    return d_ptr->format;
+}
+
+
+// VideoRelative unless the gaze points of a Tobii export are in pixels.
+GazeLog::CoordinateSpace GazeImporter::coordinateSpace(void) const
+{
+    return d_ptr->coordinateSpace;
+}
+
+
+qint64 GazeImporter::lineCount(void) const
+{
+    return d_ptr->lines;
+}
+
+
+qint64 GazeImporter::malformedLines(void) const
+{
+    return d_ptr->malformed;
+}
+
+
+// 1-based, -1 if all lines were fine
+qint64 GazeImporter::firstMalformedLine(void) const
+{
+    return d_ptr->firstMalformed;
+}
+
+
+qint64 GazeImporter::missingLines(void) const
+{
+    return d_ptr->missing;
+}
+
+
+qint64 GazeImporter::bytes(void) const
+{
+    return d_ptr->bytes;
+}
+
+
+qint64 GazeImporter::elapsedMs(void) const
+{
+    return d_ptr->elapsedMs;
+}
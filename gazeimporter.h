@@ -0,0 +1,65 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __GAZEIMPORTER_H_
+#define __GAZEIMPORTER_H_
+
+#include <QString>
+#include <QScopedPointer>
+
+#include "sample.h"
+#include "gazelog.h"
+
+
+class GazeImporterPrivate;
+
+// Imports text gaze logs: the "t;x;y" lines the program used to write and
+// tab-separated exports of Tobii software, whose header line names the
+// timestamp and gaze point columns. The file is gone through in windows
+// of WindowSize bytes, each memory-mapped or, failing that, read. Every
+// window is split into chunks at line boundaries, which are parsed in
+// parallel and then appended to the columns.
+//
+// Timestamps are converted to milliseconds. Tobii exports give gaze
+// points in pixels of the screen or of the media; coordinateSpace() tells
+// which, so that the caller can relate them to the video.
+//
+// Lines that can't be parsed are counted as malformed. Lines of a Tobii
+// export without a gaze point, e.g. while the subject blinked, are
+// counted as missing. Neither ends up in the columns.
+class GazeImporter
+{
+public:
+    enum Format {
+        UnknownFormat,
+        SemicolonSeparated,
+        TobiiTsv
+    };
+    static const qint64 WindowSize = 64 * 1024 * 1024;
+
+    explicit GazeImporter(void);
+    ~GazeImporter();
+
+    // 0 = as many as there are cores
+    void setThreadCount(int);
+    int threadCount(void) const;
+
+    bool import(const QString &filename);
+    const GazeColumns &columns(void) const;
+    Format format(void) const;
+    GazeLog::CoordinateSpace coordinateSpace(void) const;
+    qint64 lineCount(void) const;
+    qint64 malformedLines(void) const;
+    qint64 firstMalformedLine(void) const;
+    qint64 missingLines(void) const;
+    qint64 bytes(void) const;
+    qint64 elapsedMs(void) const;
+
+private:
+    QScopedPointer<GazeImporterPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(GazeImporter)
+    Q_DISABLE_COPY(GazeImporter)
+
+};
+
+#endif // __GAZEIMPORTER_H_
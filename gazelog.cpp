@@ -0,0 +1,390 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+#include <cstring>
+
+#include "gazelog.h"
+#include "gazeimporter.h"
+#include "util.h"
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "The gaze log format is little-endian and read without conversion."
+#endif
+
+namespace {
+
+const char Magic[4] = { 'D', 'V', 'G', 'Z' };
+
+// On-disk layout, all fields little-endian:
+//   Header
+//   Record records[recordCount]
+//   BlockEntry blocks[blockCount], block i covering records [i * blockSize, (i + 1) * blockSize)
+struct Header {
+    char magic[4];
+    quint32 version;
+    char device[64]; // UTF-8, zero-padded
+    qint32 sampleRate;
+    qint32 coordinateSpace;
+    qint32 recordSize;
+    qint32 blockSize;
+    qint64 recordCount;
+    qint64 blockCount;
+};
+
+}
+
+
+class GazeLogPrivate {
+public:
+    GazeLogPrivate(void)
+        : map(nullptr)
+        , base(nullptr)
+        , recordCount(0)
+        , records(nullptr)
+        , blockSize(GazeLog::DefaultBlockSize)
+        , blockCount(0)
+        , blocks(nullptr)
+    { /* ... */ }
+    // Reads the file in chunks, for when it can't be mapped.
+    bool read(void)
+    {
+        static const qint64 ChunkSize = 8 * 1024 * 1024;
+        const qint64 size = file.size();
+        if (size > maxVectorCount<char>())
+            return false;
+        data.resize(int(size));
+        for (qint64 pos = 0; pos < size; ) {
+            const qint64 n = file.read(data.data() + pos, qMin(ChunkSize, size - pos));
+            if (n <= 0) {
+                data.clear();
+                return false;
+            }
+            pos += n;
+        }
+        base = reinterpret_cast<const uchar *>(data.constData());
+        return true;
+    }
+    QFile file;
+    uchar *map;
+    // file contents if they couldn't be mapped
+    QByteArray data;
+    // start of the mapping or of `data`
+    const uchar *base;
+    GazeLog::Info info;
+    qint64 recordCount;
+    const GazeLog::Record *records;
+    int blockSize;
+    qint64 blockCount;
+    const GazeLog::BlockEntry *blocks;
+    // block index of a log that wasn't finished
+    QVector<GazeLog::BlockEntry> recoveredBlocks;
+};
+
+
+GazeLog::GazeLog(void)
+    : d_ptr(new GazeLogPrivate)
+{
+    // ...
+}
+
+
+GazeLog::~GazeLog()
+{
+    unload();
+}
+
+
+bool GazeLog::isGazeLog(const QString &filename)
+{
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    char magic[sizeof(Magic)];
+    return f.read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+
+bool GazeLog::load(const QString &filename)
+{
+    Q_D(GazeLog);
+    unload();
+    d->file.setFileName(filename);
+    if (!d->file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 mapSize = d->file.size();
+    if (mapSize < qint64(sizeof(Header))) {
+        unload();
+        return false;
+    }
+    d->map = d->file.map(0, mapSize);
+    if (d->map != nullptr) {
+        d->base = d->map;
+    }
+    else if (!d->read()) {
+        qWarning() << "GazeLog: cannot map or read" << filename;
+        unload();
+        return false;
+    }
+    const Header *hdr = reinterpret_cast<const Header *>(d->base);
+    if (hdr->recordCount == InProgress)
+        return recover();
+    // the counts are bounded by the file size before any offset is computed from them, so that a corrupt header can't overflow it
+    const qint64 payload = mapSize - qint64(sizeof(Header));
+    bool valid = memcmp(hdr->magic, Magic, sizeof(Magic)) == 0
+            && hdr->version == Version
+            && hdr->recordSize == sizeof(Record)
+            && hdr->blockSize > 0
+            && hdr->recordCount >= 0 && hdr->recordCount <= payload / qint64(sizeof(Record))
+            && hdr->blockCount >= 0 && hdr->blockCount <= payload / qint64(sizeof(BlockEntry))
+            && hdr->blockCount == hdr->recordCount / hdr->blockSize + (hdr->recordCount % hdr->blockSize != 0 ? 1 : 0);
+    const qint64 blocksOffset = valid ? qint64(sizeof(Header)) + hdr->recordCount * qint64(sizeof(Record)) : 0;
+    valid = valid && blocksOffset + hdr->blockCount * qint64(sizeof(BlockEntry)) == mapSize;
+    if (!valid) {
+        qWarning() << "GazeLog: invalid or truncated" << filename;
+        unload();
+        return false;
+    }
+    d->info.device = QString::fromUtf8(hdr->device, int(qstrnlen(hdr->device, sizeof(hdr->device))));
+    d->info.sampleRate = hdr->sampleRate;
+    d->info.coordinateSpace = CoordinateSpace(hdr->coordinateSpace);
+    d->recordCount = hdr->recordCount;
+    d->records = reinterpret_cast<const Record *>(d->base + sizeof(Header));
+    d->blockSize = hdr->blockSize;
+    d->blockCount = hdr->blockCount;
+    d->blocks = reinterpret_cast<const BlockEntry *>(d->base + blocksOffset);
+    return true;
+}
+
+
+// Makes do with the records of a log whose writer never finished.
+bool GazeLog::recover(void)
+{
+    Q_D(GazeLog);
+    const qint64 mapSize = d->file.size();
+    const Header *hdr = reinterpret_cast<const Header *>(d->base);
+    const bool valid = memcmp(hdr->magic, Magic, sizeof(Magic)) == 0
+            && hdr->version == Version
+            && hdr->recordSize == sizeof(Record)
+            && hdr->blockSize > 0;
+    if (!valid) {
+        qWarning() << "GazeLog: invalid" << d->file.fileName();
+        unload();
+        return false;
+    }
+    // a record cut short by the crash is dropped
+    d->recordCount = (mapSize - qint64(sizeof(Header))) / qint64(sizeof(Record));
+    d->records = reinterpret_cast<const Record *>(d->base + sizeof(Header));
+    d->blockSize = hdr->blockSize;
+    if ((d->recordCount + d->blockSize - 1) / d->blockSize > maxVectorCount<BlockEntry>()) {
+        qWarning() << "GazeLog: too many records in" << d->file.fileName();
+        unload();
+        return false;
+    }
+    for (qint64 i = 0; i < d->recordCount; ++i)
+        extendBlockIndex(d->recoveredBlocks, d->blockSize, i, d->records[i].timestamp);
+    d->blockCount = d->recoveredBlocks.count();
+    d->blocks = d->recoveredBlocks.constData();
+    d->info.device = QString::fromUtf8(hdr->device, int(qstrnlen(hdr->device, sizeof(hdr->device))));
+    d->info.sampleRate = hdr->sampleRate;
+    d->info.coordinateSpace = CoordinateSpace(hdr->coordinateSpace);
+    qWarning() << "GazeLog: recovered" << d->recordCount << "samples from unfinished" << d->file.fileName();
+    return true;
+}
+
+
+bool GazeLog::save(const QString &filename, const Info &info, const Samples &samples, int blockSize)
+{
+    Q_ASSERT(blockSize > 0);
+    QVector<Record> records(samples.count());
+    QVector<BlockEntry> blocks;
+    for (int i = 0; i < samples.count(); ++i) {
+        const Sample &sample = samples.at(i);
+        records[i].timestamp = sample.timestamp;
+        records[i].x = sample.pos.x();
+        records[i].y = sample.pos.y();
+        extendBlockIndex(blocks, blockSize, i, sample.timestamp);
+    }
+    QSaveFile f(filename);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write(header(info, blockSize, samples.count()));
+    f.write(reinterpret_cast<const char *>(records.constData()), records.count() * sizeof(Record));
+    f.write(reinterpret_cast<const char *>(blocks.constData()), blocks.count() * sizeof(BlockEntry));
+    return f.commit();
+}
+
+
+// Header of a log with `recordCount` records, or of one that is being
+// written if `recordCount` is InProgress.
+QByteArray GazeLog::header(const Info &info, int blockSize, qint64 recordCount)
+{
+    Header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, Magic, sizeof(Magic));
+    hdr.version = Version;
+    const QByteArray &device = info.device.toUtf8().left(sizeof(hdr.device) - 1);
+    memcpy(hdr.device, device.constData(), size_t(device.size()));
+    hdr.sampleRate = info.sampleRate;
+    hdr.coordinateSpace = info.coordinateSpace;
+    hdr.recordSize = sizeof(Record);
+    hdr.blockSize = blockSize;
+    hdr.recordCount = recordCount;
+    hdr.blockCount = recordCount == InProgress ? 0 : (recordCount + blockSize - 1) / blockSize;
+    return QByteArray(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+}
+
+
+// Accounts for the record at `recordIndex` in the block index. Records
+// have to be added in order.
+void GazeLog::extendBlockIndex(QVector<BlockEntry> &blocks, int blockSize, qint64 recordIndex, qint64 timestamp)
+{
+    if (recordIndex % blockSize == 0) {
+        BlockEntry block;
+        block.minTimestamp = timestamp;
+        block.maxTimestamp = timestamp;
+        blocks.append(block);
+    }
+    else {
+        BlockEntry &block = blocks.last();
+        block.minTimestamp = qMin(block.minTimestamp, timestamp);
+        block.maxTimestamp = qMax(block.maxTimestamp, timestamp);
+    }
+}
+
+
+void GazeLog::unload(void)
+{
+    Q_D(GazeLog);
+    if (d->map != nullptr) {
+        d->file.unmap(d->map);
+        d->map = nullptr;
+    }
+    d->data.clear();
+    d->base = nullptr;
+    d->file.close();
+    d->info = Info();
+    d->recordCount = 0;
+    d->records = nullptr;
+    d->blockSize = DefaultBlockSize;
+    d->blockCount = 0;
+    d->blocks = nullptr;
+    d->recoveredBlocks.clear();
+}
+
+
+bool GazeLog::isLoaded(void) const
+{
+    return d_ptr->base != nullptr;
+}
+
+
+// Reads a log of "t;x;y" lines or a Tobii export, see GazeImporter.
+bool GazeLog::importText(const QString &filename, Samples &samples)
+{
+    GazeImporter importer;
+    if (!importer.import(filename))
+        return false;
+    samples = importer.columns().toSamples();
+    return true;
+}
+
+
+bool GazeLog::exportText(const QString &filename, const Samples &samples)
+{
+    QSaveFile f(filename);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    foreach (const Sample &sample, samples)
+        f.write(QString("%1;%2;%3\n").arg(sample.timestamp).arg(sample.pos.x()).arg(sample.pos.y()).toLatin1());
+    return f.commit();
+}
+
+
+const GazeLog::Info &GazeLog::info(void) const
+{
+    return d_ptr->info;
+}
+
+
+qint64 GazeLog::recordCount(void) const
+{
+    return d_ptr->recordCount;
+}
+
+
+const GazeLog::Record *GazeLog::records(void) const
+{
+    return d_ptr->records;
+}
+
+
+int GazeLog::blockSize(void) const
+{
+    return d_ptr->blockSize;
+}
+
+
+qint64 GazeLog::blockCount(void) const
+{
+    return d_ptr->blockCount;
+}
+
+
+const GazeLog::BlockEntry *GazeLog::blocks(void) const
+{
+    return d_ptr->blocks;
+}
+
+
+// Index of the first block from `from` on that may hold samples in
+// [t0, t1), or -1 if there is none. Only the block index is touched, so
+// looking up a time span in a long recording pages in just the blocks
+// that overlap it.
+qint64 GazeLog::nextBlock(qint64 t0, qint64 t1, qint64 from) const
+{
+    for (qint64 i = qMax(Q_INT64_C(0), from); i < d_ptr->blockCount; ++i) {
+        const BlockEntry &block = d_ptr->blocks[i];
+        if (block.minTimestamp < t1 && block.maxTimestamp >= t0)
+            return i;
+    }
+    return -1;
+}
+
+
+// Copies at most as many records as a QVector can hold.
+GazeColumns GazeLog::columns(void) const
+{
+    GazeColumns columns;
+    const int n = int(qMin(d_ptr->recordCount, qint64(maxVectorCount<qint64>())));
+    if (n < d_ptr->recordCount)
+        qWarning() << "GazeLog: only the first" << n << "of" << d_ptr->recordCount << "samples fit into memory.";
+    columns.timestamps.resize(n);
+    columns.x.resize(n);
+    columns.y.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const Record &r = d_ptr->records[i];
+        columns.timestamps[i] = r.timestamp;
+        columns.x[i] = r.x;
+        columns.y[i] = r.y;
+    }
+    return columns;
+}
+
+
+// Copies at most as many records as a QVector can hold.
+Samples GazeLog::samples(void) const
+{
+    const int n = int(qMin(d_ptr->recordCount, qint64(maxVectorCount<Sample>())));
+    if (n < d_ptr->recordCount)
+        qWarning() << "GazeLog: only the first" << n << "of" << d_ptr->recordCount << "samples fit into memory.";
+    Samples samples(n);
+    for (int i = 0; i < samples.count(); ++i) {
+        const Record &r = d_ptr->records[i];
+        samples[i] = Sample(QPointF(r.x, r.y), r.timestamp);
+    }
+    return samples;
+}
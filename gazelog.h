@@ -0,0 +1,102 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __GAZELOG_H_
+#define __GAZELOG_H_
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QScopedPointer>
+
+#include "sample.h"
+
+
+class GazeLogPrivate;
+
+// Binary gaze log: a header describing the recording, the samples as
+// fixed-width little-endian records in the order they were recorded and
+// an index holding the time range of every block of `blockSize` records.
+//
+// The file is memory-mapped on load; records() and blocks() point
+// straight into the mapping. If it can't be mapped, e.g. for lack of
+// address space in a 32-bit build, it is read into memory instead. A
+// log whose writer never finished, e.g. after a crash, has no block
+// index; it is rebuilt on load from the records that made it to disk.
+// The old "t;x;y" text format can still be imported and exported.
+class GazeLog
+{
+public:
+    static const quint32 Version = 1;
+    static const int DefaultBlockSize = 4096;
+    // record count in the header of a log that is still being written
+    static const qint64 InProgress = -1;
+
+    enum CoordinateSpace {
+        // 0..1 across the video
+        VideoRelative = 0,
+        // pixels on the screen the tracker is calibrated for
+        ScreenPixels = 1,
+        // pixels of the video
+        MediaPixels = 2
+    };
+
+    class Info {
+    public:
+        Info(void)
+            : sampleRate(0)
+            , coordinateSpace(VideoRelative)
+        { /* ... */ }
+        QString device;
+        int sampleRate; // Hz, 0 if unknown
+        CoordinateSpace coordinateSpace;
+    };
+
+    struct Record {
+        qint64 timestamp;
+        double x;
+        double y;
+    };
+
+    // timestamps needn't ascend, they jump wherever the video was seeked to while recording
+    struct BlockEntry {
+        qint64 minTimestamp;
+        qint64 maxTimestamp;
+    };
+
+    explicit GazeLog(void);
+    ~GazeLog();
+
+    static bool isGazeLog(const QString &filename);
+
+    bool load(const QString &filename);
+    static bool save(const QString &filename, const Info &, const Samples &, int blockSize = DefaultBlockSize);
+    static QByteArray header(const Info &, int blockSize, qint64 recordCount);
+    static void extendBlockIndex(QVector<BlockEntry> &blocks, int blockSize, qint64 recordIndex, qint64 timestamp);
+    void unload(void);
+    bool isLoaded(void) const;
+
+    static bool importText(const QString &filename, Samples &);
+    static bool exportText(const QString &filename, const Samples &);
+
+    const Info &info(void) const;
+    qint64 recordCount(void) const;
+    const Record *records(void) const;
+    int blockSize(void) const;
+    qint64 blockCount(void) const;
+    const BlockEntry *blocks(void) const;
+    qint64 nextBlock(qint64 t0, qint64 t1, qint64 from = 0) const;
+    Samples samples(void) const;
+    GazeColumns columns(void) const;
+
+private: // methods
+    bool recover(void);
+
+private:
+    QScopedPointer<GazeLogPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(GazeLog)
+    Q_DISABLE_COPY(GazeLog)
+
+};
+
+#endif // __GAZELOG_H_
@@ -0,0 +1,311 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QVector>
+
+#include "gazerecorder.h"
+
+
+namespace {
+
+// Ring buffer for exactly one producer and one consumer. The producer
+// only ever moves `head` and the consumer only `tail`, so neither has to
+// lock; one slot stays empty to tell a full buffer from an empty one.
+class RecordQueue {
+public:
+    explicit RecordQueue(int capacity)
+        : size(capacity + 1)
+        , buffer(new GazeLog::Record[size])
+        , head(0)
+        , tail(0)
+    { /* ... */ }
+    ~RecordQueue()
+    {
+        delete [] buffer;
+    }
+    bool push(const GazeLog::Record &record)
+    {
+        const int h = head.load();
+        const int next = (h + 1) % size;
+        if (next == tail.loadAcquire())
+            return false;
+        buffer[h] = record;
+        head.storeRelease(next);
+        return true;
+    }
+    bool pop(GazeLog::Record &record)
+    {
+        const int t = tail.load();
+        if (t == head.loadAcquire())
+            return false;
+        record = buffer[t];
+        tail.storeRelease((t + 1) % size);
+        return true;
+    }
+    int count(void) const
+    {
+        return (head.loadAcquire() - tail.loadAcquire() + size) % size;
+    }
+    void clear(void)
+    {
+        head.store(0);
+        tail.store(0);
+    }
+    int capacity(void) const
+    {
+        return size - 1;
+    }
+
+private:
+    const int size;
+    GazeLog::Record *buffer;
+    QAtomicInt head;
+    QAtomicInt tail;
+};
+
+}
+
+
+class GazeRecorderPrivate {
+public:
+    GazeRecorderPrivate(void)
+        : queue(GazeRecorder::DefaultQueueCapacity)
+        , flushIntervalMs(GazeRecorder::DefaultFlushIntervalMs)
+        , doAbort(false)
+        , dataOffset(0)
+        , writeFailed(false)
+        , recordCount(0)
+        , highWaterMark(0)
+        , dropped(0)
+        , bytesWritten(0)
+        , writeNs(0)
+        , writes(0)
+    { /* ... */ }
+    RecordQueue queue;
+    QFile file;
+    GazeLog::Info info;
+    int flushIntervalMs;
+    QMutex abortMutex;
+    QWaitCondition abortCond;
+    bool doAbort;
+    QVector<GazeLog::BlockEntry> blocks;
+    qint64 dataOffset;
+    // after a failed write the log ends with the records written before, see close()
+    bool writeFailed;
+    qint64 recordCount;
+    // only written by the producer
+    QAtomicInt highWaterMark;
+    // also counts the samples lost to a failed write
+    QAtomicInt dropped;
+    qint64 bytesWritten;
+    qint64 writeNs;
+    int writes;
+};
+
+
+GazeRecorder::GazeRecorder(QObject *parent)
+    : QThread(parent)
+    , d_ptr(new GazeRecorderPrivate)
+{
+    // ...
+}
+
+
+GazeRecorder::~GazeRecorder()
+{
+    close();
+}
+
+
+// Creates the log and starts recording into it. An existing file is left
+// alone, it may be the log of an earlier session.
+bool GazeRecorder::open(const QString &filename, const GazeLog::Info &info)
+{
+    Q_D(GazeRecorder);
+    close();
+    if (QFile::exists(filename)) {
+        qWarning() << "GazeRecorder: won't overwrite" << filename;
+        return false;
+    }
+    d->file.setFileName(filename);
+    if (!d->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "GazeRecorder: cannot create" << filename;
+        return false;
+    }
+    d->info = info;
+    const QByteArray &header = GazeLog::header(info, GazeLog::DefaultBlockSize, GazeLog::InProgress);
+    if (d->file.write(header) != header.size() || !d->file.flush()) {
+        qWarning() << "GazeRecorder: cannot write to" << filename;
+        d->file.close();
+        return false;
+    }
+    d->dataOffset = header.size();
+    d->writeFailed = false;
+    d->queue.clear();
+    d->blocks.clear();
+    d->recordCount = 0;
+    d->highWaterMark.store(0);
+    d->dropped.store(0);
+    d->bytesWritten = 0;
+    d->writeNs = 0;
+    d->writes = 0;
+    d->doAbort = false;
+    start(QThread::LowPriority);
+    return true;
+}
+
+
+// Writes the samples still queued, appends the block index and completes
+// the header. If anything of that fails, the header is left InProgress and
+// the file ends with the last record written, so that GazeLog::recover()
+// can make use of it.
+void GazeRecorder::close(void)
+{
+    Q_D(GazeRecorder);
+    if (!isRunning())
+        return;
+    d->abortMutex.lock();
+    d->doAbort = true;
+    d->abortCond.wakeOne();
+    d->abortMutex.unlock();
+    wait();
+    const qint64 indexBytes = d->blocks.count() * qint64(sizeof(GazeLog::BlockEntry));
+    bool ok = !d->writeFailed
+            && d->file.write(reinterpret_cast<const char *>(d->blocks.constData()), indexBytes) == indexBytes
+            && d->file.flush()
+            && d->file.seek(0);
+    if (ok) {
+        const QByteArray &header = GazeLog::header(d->info, GazeLog::DefaultBlockSize, d->recordCount);
+        ok = d->file.write(header) == header.size() && d->file.flush();
+    }
+    if (!ok) {
+        qWarning() << "GazeRecorder: cannot complete" << d->file.fileName() << "- it is recovered when loaded.";
+        d->file.resize(d->dataOffset + d->recordCount * qint64(sizeof(GazeLog::Record)));
+    }
+    d->file.close();
+    logStatistics();
+}
+
+
+bool GazeRecorder::isRecording(void) const
+{
+    return isRunning();
+}
+
+
+QString GazeRecorder::filename(void) const
+{
+    return d_ptr->file.fileName();
+}
+
+
+// Takes effect with the next flush.
+void GazeRecorder::setFlushInterval(int ms)
+{
+    Q_D(GazeRecorder);
+    QMutexLocker locker(&d->abortMutex);
+    d->flushIntervalMs = qMax(1, ms);
+}
+
+
+int GazeRecorder::flushInterval(void) const
+{
+    return d_ptr->flushIntervalMs;
+}
+
+
+// Queues a sample for writing. Must only be called from one thread at a time.
+bool GazeRecorder::append(const Sample &sample)
+{
+    Q_D(GazeRecorder);
+    GazeLog::Record record;
+    record.timestamp = sample.timestamp;
+    record.x = sample.pos.x();
+    record.y = sample.pos.y();
+    if (!d->queue.push(record)) {
+        d->dropped.ref();
+        return false;
+    }
+    const int n = d->queue.count();
+    if (n > d->highWaterMark.load())
+        d->highWaterMark.store(n);
+    return true;
+}
+
+
+qint64 GazeRecorder::samplesWritten(void) const
+{
+    return d_ptr->recordCount;
+}
+
+
+int GazeRecorder::queueHighWaterMark(void) const
+{
+    return d_ptr->highWaterMark.load();
+}
+
+
+int GazeRecorder::droppedSamples(void) const
+{
+    return d_ptr->dropped.load();
+}
+
+
+void GazeRecorder::run(void)
+{
+    Q_D(GazeRecorder);
+    QVector<GazeLog::Record> batch;
+    batch.reserve(d->queue.capacity());
+    bool abort = false;
+    while (!abort) {
+        d->abortMutex.lock();
+        if (!d->doAbort)
+            d->abortCond.wait(&d->abortMutex, ulong(d->flushIntervalMs));
+        abort = d->doAbort;
+        d->abortMutex.unlock();
+        GazeLog::Record record;
+        while (d->queue.pop(record))
+            batch.append(record);
+        if (batch.isEmpty())
+            continue;
+        if (d->writeFailed) {
+            d->dropped.fetchAndAddRelaxed(batch.count());
+            batch.clear();
+            continue;
+        }
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+        const qint64 bytes = batch.count() * qint64(sizeof(GazeLog::Record));
+        if (d->file.write(reinterpret_cast<const char *>(batch.constData()), bytes) != bytes || !d->file.flush()) {
+            qWarning() << "GazeRecorder: cannot write to" << d->file.fileName() << "- recording stops after" << d->recordCount << "samples.";
+            d->writeFailed = true;
+            d->dropped.fetchAndAddRelaxed(batch.count());
+            batch.clear();
+            continue;
+        }
+        d->writeNs += writeTimer.nsecsElapsed();
+        for (int i = 0; i < batch.count(); ++i)
+            GazeLog::extendBlockIndex(d->blocks, GazeLog::DefaultBlockSize, d->recordCount + i, batch.at(i).timestamp);
+        d->bytesWritten += bytes;
+        d->recordCount += batch.count();
+        ++d->writes;
+        batch.clear();
+    }
+}
+
+
+void GazeRecorder::logStatistics(void)
+{
+    Q_D(GazeRecorder);
+    qDebug() << "GazeRecorder: wrote" << d->recordCount << "samples to" << d->file.fileName()
+             << "in" << d->writes << "writes,"
+             << (d->writeNs > 0 ? 1e9 * d->bytesWritten / d->writeNs / 1024 / 1024 : 0) << "MB/s;"
+             << "queue high-water mark:" << d->highWaterMark.load() << "of" << d->queue.capacity()
+             << "dropped samples:" << d->dropped.load();
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __GAZERECORDER_H_
+#define __GAZERECORDER_H_
+
+#include <QThread>
+#include <QString>
+#include <QScopedPointer>
+
+#include "sample.h"
+#include "gazelog.h"
+
+
+class GazeRecorderPrivate;
+
+// Writes gaze samples to a binary gaze log while they come in. append()
+// puts a sample into a lock-free queue and never blocks; the recorder
+// thread empties the queue every `flushInterval` ms and writes what it
+// found in one go. The log is complete up to the last flush at any time,
+// see GazeLog for how an unfinished log is read. If the queue overflows
+// because the flush interval is too long for the sample rate, samples are
+// dropped and counted.
+class GazeRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    static const int DefaultQueueCapacity = 65536;
+    static const int DefaultFlushIntervalMs = 1000;
+
+    explicit GazeRecorder(QObject *parent = nullptr);
+    virtual ~GazeRecorder();
+
+    bool open(const QString &filename, const GazeLog::Info &);
+    void close(void);
+    bool isRecording(void) const;
+    QString filename(void) const;
+    void setFlushInterval(int ms);
+    int flushInterval(void) const;
+    bool append(const Sample &);
+    qint64 samplesWritten(void) const;
+    int queueHighWaterMark(void) const;
+    int droppedSamples(void) const;
+
+protected:
+    virtual void run(void);
+
+private: // methods
+    void logStatistics(void);
+
+private:
+    QScopedPointer<GazeRecorderPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(GazeRecorder)
+    Q_DISABLE_COPY(GazeRecorder)
+
+};
+
+#endif // __GAZERECORDER_H_
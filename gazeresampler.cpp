@@ -0,0 +1,224 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QHash>
+#include <QPair>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <qnumeric.h>
+#include <algorithm>
+
+#include "gazeresampler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+struct Reduction {
+    double sumX;
+    double sumY;
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+};
+
+
+// Sums, minima and maxima of `n` > 0 coordinates.
+Reduction reduce(const double *x, const double *y, int n)
+{
+    Reduction r;
+    int i = 0;
+#ifdef RESAMPLE_SSE2
+    if (n >= 2) {
+        __m128d sumX = _mm_setzero_pd();
+        __m128d sumY = _mm_setzero_pd();
+        __m128d minX = _mm_loadu_pd(x);
+        __m128d maxX = minX;
+        __m128d minY = _mm_loadu_pd(y);
+        __m128d maxY = minY;
+        for (; i + 2 <= n; i += 2) {
+            const __m128d vx = _mm_loadu_pd(x + i);
+            const __m128d vy = _mm_loadu_pd(y + i);
+            sumX = _mm_add_pd(sumX, vx);
+            sumY = _mm_add_pd(sumY, vy);
+            minX = _mm_min_pd(minX, vx);
+            maxX = _mm_max_pd(maxX, vx);
+            minY = _mm_min_pd(minY, vy);
+            maxY = _mm_max_pd(maxY, vy);
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, sumX);
+        r.sumX = lanes[0] + lanes[1];
+        _mm_storeu_pd(lanes, sumY);
+        r.sumY = lanes[0] + lanes[1];
+        _mm_storeu_pd(lanes, minX);
+        r.minX = qMin(lanes[0], lanes[1]);
+        _mm_storeu_pd(lanes, maxX);
+        r.maxX = qMax(lanes[0], lanes[1]);
+        _mm_storeu_pd(lanes, minY);
+        r.minY = qMin(lanes[0], lanes[1]);
+        _mm_storeu_pd(lanes, maxY);
+        r.maxY = qMax(lanes[0], lanes[1]);
+    }
+    else
+#endif
+    {
+        r.sumX = r.sumY = 0;
+        r.minX = r.maxX = x[0];
+        r.minY = r.maxY = y[0];
+    }
+    for (; i < n; ++i) {
+        r.sumX += x[i];
+        r.sumY += y[i];
+        r.minX = qMin(r.minX, x[i]);
+        r.maxX = qMax(r.maxX, x[i]);
+        r.minY = qMin(r.minY, y[i]);
+        r.maxY = qMax(r.maxY, y[i]);
+    }
+    return r;
+}
+
+
+// Median of `n` > 0 values, `scratch` gets reordered.
+double median(QVector<double> &scratch, const double *values, int n)
+{
+    scratch.resize(n);
+    std::copy(values, values + n, scratch.begin());
+    const QVector<double>::iterator mid = scratch.begin() + n / 2;
+    std::nth_element(scratch.begin(), mid, scratch.end());
+    if (n % 2 == 1)
+        return *mid;
+    // nth_element leaves the lower half in front of `mid`, its largest element is the other middle value
+    return 0.5 * (*mid + *std::max_element(scratch.begin(), mid));
+}
+
+}
+
+
+// Index of the frame on screen at time `t`, -1 before the first frame.
+int FrameGaze::frameAt(qint64 t) const
+{
+    return int(std::upper_bound(pts.constBegin(), pts.constEnd(), t) - pts.constBegin()) - 1;
+}
+
+
+class GazeResamplerPrivate {
+public:
+    typedef QPair<QString, QString> Key;
+    QHash<Key, QSharedPointer<const FrameGaze> > cache;
+    // a video replaced under the same name has other frames
+    static Key key(const QString &log, const QString &video)
+    {
+        const QFileInfo fi(video);
+        return qMakePair(log, QString("%1|%2|%3").arg(video).arg(fi.size()).arg(fi.lastModified().toMSecsSinceEpoch()));
+    }
+};
+
+
+GazeResampler::GazeResampler(void)
+    : d_ptr(new GazeResamplerPrivate)
+{
+    // ...
+}
+
+
+GazeResampler::~GazeResampler()
+{
+    // ...
+}
+
+
+// `sorted` must be sorted by timestamp, as GazeStore keeps it, and
+// `framePts` ascending. The last frame is taken to last `lastFrameDurationMs`.
+FrameGaze GazeResampler::resample(const GazeColumns &sorted, const QVector<qint64> &framePts, qint64 lastFrameDurationMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const int frames = framePts.count();
+    FrameGaze fg;
+    fg.pts = framePts;
+    fg.count.resize(frames);
+    fg.meanX.resize(frames);
+    fg.meanY.resize(frames);
+    fg.medianX.resize(frames);
+    fg.medianY.resize(frames);
+    fg.dispersion.resize(frames);
+    const qint64 *t = sorted.timestamps.constData();
+    const double *x = sorted.x.constData();
+    const double *y = sorted.y.constData();
+    const int n = sorted.count();
+    QVector<double> scratch;
+    int first = 0;
+    for (int f = 0; f < frames; ++f) {
+        const qint64 begin = framePts.at(f);
+        const qint64 end = (f + 1 < frames) ? framePts.at(f + 1) : begin + lastFrameDurationMs;
+        while (first < n && t[first] < begin)
+            ++first;
+        int last = first;
+        while (last < n && t[last] < end)
+            ++last;
+        const int count = last - first;
+        fg.count[f] = count;
+        if (count == 0) {
+            fg.meanX[f] = fg.meanY[f] = fg.medianX[f] = fg.medianY[f] = fg.dispersion[f] = qQNaN();
+            continue;
+        }
+        const Reduction &r = reduce(x + first, y + first, count);
+        fg.meanX[f] = r.sumX / count;
+        fg.meanY[f] = r.sumY / count;
+        fg.medianX[f] = median(scratch, x + first, count);
+        fg.medianY[f] = median(scratch, y + first, count);
+        fg.dispersion[f] = (r.maxX - r.minX) + (r.maxY - r.minY);
+        first = last;
+    }
+    qDebug() << "GazeResampler:" << n << "samples onto" << frames << "frames in" << timer.elapsed() << "ms";
+    return fg;
+}
+
+
+// The cached result for the pair, a null pointer if there is none.
+QSharedPointer<const FrameGaze> GazeResampler::frameGaze(const QString &log, const QString &video) const
+{
+    return d_ptr->cache.value(GazeResamplerPrivate::key(log, video));
+}
+
+
+// The cached result for the pair, computed first if need be.
+QSharedPointer<const FrameGaze> GazeResampler::frameGaze(const QString &log, const QString &video,
+                                                         const GazeColumns &sorted, const QVector<qint64> &framePts, qint64 lastFrameDurationMs)
+{
+    Q_D(GazeResampler);
+    const GazeResamplerPrivate::Key &key = GazeResamplerPrivate::key(log, video);
+    QSharedPointer<const FrameGaze> fg = d->cache.value(key);
+    if (fg.isNull()) {
+        fg = QSharedPointer<const FrameGaze>(new FrameGaze(resample(sorted, framePts, lastFrameDurationMs)));
+        d->cache.insert(key, fg);
+    }
+    return fg;
+}
+
+
+// To be called when the log has been loaded anew.
+void GazeResampler::invalidateLog(const QString &log)
+{
+    Q_D(GazeResampler);
+    QMutableHashIterator<GazeResamplerPrivate::Key, QSharedPointer<const FrameGaze> > it(d->cache);
+    while (it.hasNext()) {
+        if (it.next().key().first == log)
+            it.remove();
+    }
+}
+
+
+void GazeResampler::clear(void)
+{
+    Q_D(GazeResampler);
+    d->cache.clear();
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __GAZERESAMPLER_H_
+#define __GAZERESAMPLER_H_
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QScopedPointer>
+
+#include "sample.h"
+
+
+// Gaze per video frame, one entry per frame in each column. A frame is
+// displayed from its pts until the next frame's pts; frames without a
+// sample in that interval have a count of 0 and NaN positions.
+class FrameGaze {
+public:
+    int frameCount(void) const
+    {
+        return pts.count();
+    }
+    int frameAt(qint64 t) const;
+    QVector<qint64> pts;
+    QVector<int> count;
+    QVector<double> meanX;
+    QVector<double> meanY;
+    QVector<double> medianX;
+    QVector<double> medianY;
+    // (max x - min x) + (max y - min y), as used for fixation detection by dispersion
+    QVector<double> dispersion;
+};
+
+
+class GazeResamplerPrivate;
+
+// Resamples gaze onto video frames. Samples and frames are both sorted
+// by time, so one pass over the two suffices; the sums, minima and
+// maxima of each frame's samples are reduced two at a time with SSE2
+// where available. Results are kept per pair of gaze log and video, so
+// that overlays and exports needn't compute them again; a video whose
+// size or modification time changed counts as a different one.
+class GazeResampler
+{
+public:
+    explicit GazeResampler(void);
+    ~GazeResampler();
+
+    static FrameGaze resample(const GazeColumns &sorted, const QVector<qint64> &framePts, qint64 lastFrameDurationMs);
+
+    QSharedPointer<const FrameGaze> frameGaze(const QString &log, const QString &video) const;
+    QSharedPointer<const FrameGaze> frameGaze(const QString &log, const QString &video,
+                                              const GazeColumns &sorted, const QVector<qint64> &framePts, qint64 lastFrameDurationMs);
+    void invalidateLog(const QString &log);
+    void clear(void);
+
+private:
+    QScopedPointer<GazeResamplerPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(GazeResampler)
+    Q_DISABLE_COPY(GazeResampler)
+
+};
+
+#endif // __GAZERESAMPLER_H_
@@ -0,0 +1,217 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QVector>
+#include <algorithm>
+
+#include "gazestore.h"
+
+
+class GazeStorePrivate {
+public:
+    GazeColumns columns;
+};
+
+
+GazeStore::GazeStore(void)
+    : d_ptr(new GazeStorePrivate)
+{
+    // ...
+}
+
+
+GazeStore::~GazeStore()
+{
+    // ...
+}
+
+
+// Recorded timestamps follow the video position and jump back whenever
+// the video was seeked, so the samples are sorted unless they already are.
+// Samples with equal timestamps keep their order.
+void GazeStore::setColumns(const GazeColumns &columns)
+{
+    Q_D(GazeStore);
+    const QVector<qint64> &ts = columns.timestamps;
+    if (std::is_sorted(ts.constBegin(), ts.constEnd())) {
+        d->columns = columns;
+        return;
+    }
+    QVector<int> order(columns.count());
+    for (int i = 0; i < order.count(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&ts](int a, int b) { return ts.at(a) < ts.at(b); });
+    d->columns.timestamps.resize(order.count());
+    d->columns.x.resize(order.count());
+    d->columns.y.resize(order.count());
+    for (int i = 0; i < order.count(); ++i) {
+        d->columns.timestamps[i] = ts.at(order.at(i));
+        d->columns.x[i] = columns.x.at(order.at(i));
+        d->columns.y[i] = columns.y.at(order.at(i));
+    }
+}
+
+
+void GazeStore::setSamples(const Samples &samples)
+{
+    GazeColumns columns;
+    columns.timestamps.resize(samples.count());
+    columns.x.resize(samples.count());
+    columns.y.resize(samples.count());
+    for (int i = 0; i < samples.count(); ++i) {
+        columns.timestamps[i] = samples.at(i).timestamp;
+        columns.x[i] = samples.at(i).pos.x();
+        columns.y[i] = samples.at(i).pos.y();
+    }
+    setColumns(columns);
+}
+
+
+void GazeStore::clear(void)
+{
+    Q_D(GazeStore);
+    d->columns.clear();
+}
+
+
+bool GazeStore::isEmpty(void) const
+{
+    return d_ptr->columns.count() == 0;
+}
+
+
+int GazeStore::count(void) const
+{
+    return d_ptr->columns.count();
+}
+
+
+const GazeColumns &GazeStore::columns(void) const
+{
+    return d_ptr->columns;
+}
+
+
+qint64 GazeStore::timestamp(int i) const
+{
+    return d_ptr->columns.timestamps.at(i);
+}
+
+
+QPointF GazeStore::pos(int i) const
+{
+    return QPointF(d_ptr->columns.x.at(i), d_ptr->columns.y.at(i));
+}
+
+
+Sample GazeStore::sample(int i) const
+{
+    return Sample(pos(i), timestamp(i));
+}
+
+
+// Index of the first sample at or after `t`, count() if there is none.
+int GazeStore::lowerBound(qint64 t) const
+{
+    const QVector<qint64> &ts = d_ptr->columns.timestamps;
+    return int(std::lower_bound(ts.constBegin(), ts.constEnd(), t) - ts.constBegin());
+}
+
+
+// Indexes [first, last) of the samples in [t0, t1).
+QPair<int, int> GazeStore::range(qint64 t0, qint64 t1) const
+{
+    const int first = lowerBound(t0);
+    const QVector<qint64> &ts = d_ptr->columns.timestamps;
+    const int last = int(std::lower_bound(ts.constBegin() + first, ts.constEnd(), qMax(t0, t1)) - ts.constBegin());
+    return qMakePair(first, last);
+}
+
+
+// Index of the sample closest to `t`, -1 if the store is empty.
+int GazeStore::nearest(qint64 t) const
+{
+    if (isEmpty())
+        return -1;
+    const int i = lowerBound(t);
+    if (i == count())
+        return i - 1;
+    if (i > 0 && t - timestamp(i - 1) <= timestamp(i) - t)
+        return i - 1;
+    return i;
+}
+
+
+GazeStore::Cursor::Cursor(const GazeStore *store)
+    : store(store)
+    , pos(0)
+    , lastT(0)
+{
+    // ...
+}
+
+
+void GazeStore::Cursor::setStore(const GazeStore *s)
+{
+    store = s;
+    reset();
+}
+
+
+// To be called whenever the store's samples change.
+void GazeStore::Cursor::reset(void)
+{
+    pos = 0;
+    lastT = 0;
+}
+
+
+// Searches forward from `from` in steps of growing size until the
+// timestamp is passed, then bisects the last step. Costs O(log d) for a
+// distance of d samples instead of O(log n).
+int GazeStore::Cursor::gallop(int from, qint64 t) const
+{
+    const QVector<qint64> &ts = store->columns().timestamps;
+    const int n = ts.count();
+    int lo = from;
+    int step = 1;
+    while (lo + step < n && ts.at(lo + step) < t) {
+        lo += step;
+        step *= 2;
+    }
+    const int hi = qMin(n, lo + step + 1);
+    return int(std::lower_bound(ts.constBegin() + lo, ts.constBegin() + hi, t) - ts.constBegin());
+}
+
+
+int GazeStore::Cursor::lowerBound(qint64 t)
+{
+    Q_ASSERT(store != nullptr);
+    if (pos > store->count() || t < lastT || (pos > 0 && store->timestamp(pos - 1) >= t))
+        pos = store->lowerBound(t);
+    else
+        pos = gallop(pos, t);
+    lastT = t;
+    return pos;
+}
+
+
+QPair<int, int> GazeStore::Cursor::range(qint64 t0, qint64 t1)
+{
+    const int first = lowerBound(t0);
+    return qMakePair(first, t1 > t0 ? gallop(first, t1) : first);
+}
+
+
+int GazeStore::Cursor::nearest(qint64 t)
+{
+    if (store == nullptr || store->isEmpty())
+        return -1;
+    const int i = lowerBound(t);
+    if (i == store->count())
+        return i - 1;
+    if (i > 0 && t - store->timestamp(i - 1) <= store->timestamp(i) - t)
+        return i - 1;
+    return i;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __GAZESTORE_H_
+#define __GAZESTORE_H_
+
+#include <QPair>
+#include <QPointF>
+#include <QScopedPointer>
+
+#include "sample.h"
+
+
+class GazeStorePrivate;
+
+// Gaze samples sorted by timestamp for lookups by video position:
+// the samples in [t0, t1) and the sample nearest to t, both by binary
+// search. A Cursor remembers where the last lookup ended; as long as the
+// times asked for don't go backwards, as during playback, it only
+// searches ahead of that point, which costs O(1) per frame on average.
+class GazeStore
+{
+public:
+    class Cursor {
+    public:
+        explicit Cursor(const GazeStore *store = nullptr);
+        void setStore(const GazeStore *);
+        void reset(void);
+        int lowerBound(qint64 t);
+        QPair<int, int> range(qint64 t0, qint64 t1);
+        int nearest(qint64 t);
+
+    private:
+        int gallop(int from, qint64 t) const;
+        const GazeStore *store;
+        int pos;
+        qint64 lastT;
+    };
+
+    explicit GazeStore(void);
+    ~GazeStore();
+
+    void setColumns(const GazeColumns &);
+    void setSamples(const Samples &);
+    void clear(void);
+    bool isEmpty(void) const;
+    int count(void) const;
+    const GazeColumns &columns(void) const;
+    qint64 timestamp(int i) const;
+    QPointF pos(int i) const;
+    Sample sample(int i) const;
+
+    int lowerBound(qint64 t) const;
+    QPair<int, int> range(qint64 t0, qint64 t1) const;
+    int nearest(qint64 t) const;
+
+private:
+    QScopedPointer<GazeStorePrivate> d_ptr;
+    Q_DECLARE_PRIVATE(GazeStore)
+    Q_DISABLE_COPY(GazeStore)
+
+};
+
+#endif // __GAZESTORE_H_
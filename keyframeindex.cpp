@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <algorithm>
+
+#include "keyframeindex.h"
+
+
+class KeyframeIndexPrivate {
+public:
+    KeyframeIndexPrivate(void)
+    { /* ... */ }
+    mutable QMutex mtx;
+    QVector<KeyframeIndex::Entry> entries;
+};
+
+
+static bool ptsLessThan(const KeyframeIndex::Entry &a, const KeyframeIndex::Entry &b)
+{
+    return a.pts < b.pts;
+}
+
+
+KeyframeIndex::KeyframeIndex(void)
+    : d_ptr(new KeyframeIndexPrivate)
+{
+    // ...
+}
+
+
+KeyframeIndex::~KeyframeIndex()
+{
+    // ...
+}
+
+
+void KeyframeIndex::clear(void)
+{
+    Q_D(KeyframeIndex);
+    QMutexLocker locker(&d->mtx);
+    d->entries.clear();
+}
+
+
+// Keyframes usually arrive in ascending order, so appending is the common case.
+void KeyframeIndex::add(qint64 pts, qint64 pos)
+{
+    Q_D(KeyframeIndex);
+    const Entry entry(pts, pos);
+    QMutexLocker locker(&d->mtx);
+    if (d->entries.isEmpty() || d->entries.last().pts < pts) {
+        d->entries.append(entry);
+        return;
+    }
+    QVector<Entry>::iterator it = std::lower_bound(d->entries.begin(), d->entries.end(), entry, ptsLessThan);
+    if (it != d->entries.end() && it->pts == pts)
+        return;
+    d->entries.insert(it, entry);
+}
+
+
+// Returns the last keyframe at or before `pts`, or an invalid entry if there is none.
+KeyframeIndex::Entry KeyframeIndex::preceding(qint64 pts) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    const QVector<Entry> &entries = d_ptr->entries;
+    QVector<Entry>::const_iterator it = std::upper_bound(entries.constBegin(), entries.constEnd(), Entry(pts, -1), ptsLessThan);
+    if (it == entries.constBegin())
+        return Entry();
+    return *(it - 1);
+}
+
+
+QVector<KeyframeIndex::Entry> KeyframeIndex::entries(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->entries;
+}
+
+
+int KeyframeIndex::count(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->entries.count();
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __KEYFRAMEINDEX_H_
+#define __KEYFRAMEINDEX_H_
+
+#include <QtGlobal>
+#include <QScopedPointer>
+#include <QVector>
+
+
+class KeyframeIndexPrivate;
+
+// Sorted list of keyframe timestamps (in stream time base units) and their
+// byte offsets in the container. Entries may be added from any thread.
+class KeyframeIndex
+{
+public:
+    class Entry {
+    public:
+        Entry(void)
+            : pts(0)
+            , pos(-1)
+            , valid(false)
+        { /* ... */ }
+        Entry(qint64 pts, qint64 pos)
+            : pts(pts)
+            , pos(pos)
+            , valid(true)
+        { /* ... */ }
+        bool isValid(void) const { return valid; }
+        qint64 pts;
+        qint64 pos;
+    private:
+        bool valid;
+    };
+
+    explicit KeyframeIndex(void);
+    ~KeyframeIndex();
+
+    void clear(void);
+    void add(qint64 pts, qint64 pos);
+    Entry preceding(qint64 pts) const;
+    int count(void) const;
+    QVector<Entry> entries(void) const;
+
+private:
+    QScopedPointer<KeyframeIndexPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(KeyframeIndex)
+    Q_DISABLE_COPY(KeyframeIndex)
+
+};
+
+#endif // __KEYFRAMEINDEX_H_
@@ -1,19 +1,19 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#ifndef __MAIN_H_
-#define __MAIN_H_
-
-#include <QString>
-
-extern const QString Company;
-extern const QString CompanyDomain;
-extern const QString AppName;
-extern const QString AppUrl;
-extern const QString AppAuthor;
-extern const QString AppAuthorMail;
-extern const QString AppVersion;
-extern const QString AppMinorVersion;
-extern const QString AppVersionNoDebug;
-
-#endif // __MAIN_H_
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __MAIN_H_
+#define __MAIN_H_
+
+#include <QString>
+
+extern const QString Company;
+extern const QString CompanyDomain;
+extern const QString AppName;
+extern const QString AppUrl;
+extern const QString AppAuthor;
+extern const QString AppAuthorMail;
+extern const QString AppVersion;
+extern const QString AppMinorVersion;
+extern const QString AppVersionNoDebug;
+
+#endif // __MAIN_H_
@@ -1,380 +1,1112 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#include <QtCore/QDebug>
-#include <QMediaPlayer>
-#include <QMediaPlaylist>
-#include <QSettings>
-#include <QFileDialog>
-#include <QFileInfo>
-#include <QDir>
-#include <QProgressBar>
-#include <QPushButton>
-#include <QHBoxLayout>
-
-#include "main.h"
-#include "sample.h"
-#include "decoderthread.h"
-#include "renderwidget.h"
-#include "quiltwidget.h"
-#include "videowidget.h"
-#include "mainwindow.h"
-#include "ui_mainwindow.h"
-#include "eyexhost.h"
-
-class MainWindowPrivate {
-public:
-     MainWindowPrivate()
-         : quiltWidget(new QuiltWidget)
-         , renderWidget(new RenderWidget)
-         , videoWidget(new VideoWidget)
-         , player(new QMediaPlayer)
-         , playlist(new QMediaPlaylist)
-         , decoderThread(new DecoderThread)
-     { /* ... */ }
-     ~MainWindowPrivate()
-     {
-         delete player;
-         delete playlist;
-         delete videoWidget;
-         delete renderWidget;
-         delete quiltWidget;
-         delete decoderThread;
-     }
-     Samples gazeSamples;
-     QuiltWidget *quiltWidget;
-     RenderWidget *renderWidget;
-     VideoWidget *videoWidget;
-     QMediaPlayer *player;
-     QMediaPlaylist *playlist;
-     QPushButton *playButton;
-     QProgressBar *positionSlider;
-     QString currentVideoFilename;
-     QString lastOpenVideoDir;
-     QString currentGazeDataFilename;
-     QString lastOpenGazeDataDir;
-     QString lastSaveDir;
-     DecoderThread *decoderThread;
-};
-
-
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
-    , ui(new Ui::MainWindow)
-    , d_ptr(new MainWindowPrivate())
-{
-    Q_D(MainWindow);
-    ui->setupUi(this);
-    setWindowTitle(tr("%1 %2").arg(AppName).arg(AppVersion));
-
-    d->playButton = new QPushButton;
-    d->playButton->setEnabled(false);
-    d->playButton->setMinimumWidth(50);
-    d->playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-
-    d->positionSlider = new QProgressBar;
-    d->positionSlider->setRange(0, 100);
-
-    QBoxLayout *controlLayout = new QHBoxLayout;
-    controlLayout->setMargin(0);
-    controlLayout->addWidget(d->playButton);
-    controlLayout->addWidget(d->positionSlider);
-
-    QObject::connect(EyeXHost::instance(), SIGNAL(gazeSampleReady(Sample)), SLOT(addGazeSample(Sample)));
-    QObject::connect(d->decoderThread, SIGNAL(frameReady(QImage, int)), d->renderWidget, SLOT(setFrame(QImage, int)));
-    QObject::connect(d->decoderThread, SIGNAL(positionChanged(qint64)), SLOT(positionChanged(qint64)));
-    QObject::connect(d->decoderThread, SIGNAL(durationChanged(qint64)), SLOT(durationChanged(qint64)));
-    QObject::connect(d->videoWidget->videoSurface(), SIGNAL(frameReady(QImage, int)), SLOT(setFrame(QImage, int)));
-    QObject::connect(d->videoWidget->videoSurface(), SIGNAL(frameReady(QImage, int)), d->renderWidget, SLOT(setFrame(QImage, int)));
-    QObject::connect(d->renderWidget, SIGNAL(ready()), SLOT(renderWidgetReady()));
-    QObject::connect(d->videoWidget, SIGNAL(virtualGazePointChanged(QPointF)), SLOT(setVirtualGazePoint(QPointF)));
-
-    QObject::connect(ui->actionVisualizeGaze, SIGNAL(toggled(bool)), d->videoWidget, SLOT(setVisualisation(bool)));
-    QObject::connect(ui->actionOpenVideo, SIGNAL(triggered()), SLOT(openVideo()));
-    QObject::connect(ui->actionOpenGazeData, SIGNAL(triggered()), SLOT(openGazeData()));
-    QObject::connect(ui->actionExit, SIGNAL(triggered()), SLOT(close()));
-
-    ui->presentGridLayout->addWidget(d->videoWidget, 0, 0);
-    ui->presentGridLayout->addLayout(controlLayout, 1, 0);
-    d->videoWidget->show();
-    d->renderWidget->show();
-    d->quiltWidget->show();
-
-    QObject::connect(d->player, SIGNAL(positionChanged(qint64)), SLOT(positionChanged(qint64)));
-    QObject::connect(d->player, SIGNAL(durationChanged(qint64)), SLOT(durationChanged(qint64)));
-    QObject::connect(d->player, SIGNAL(stateChanged(QMediaPlayer::State)), SLOT(mediaStateChanged(QMediaPlayer::State)));
-    QObject::connect(d->player, SIGNAL(error(QMediaPlayer::Error)), SLOT(handleError()));
-    QObject::connect(d->playButton, SIGNAL(clicked()), SLOT(play()));
-
-    restoreSettings();    
-}
-
-
-void MainWindow::updateWindowTitle(void)
-{
-    setWindowTitle(tr("%1 %2 (OpenGL %3)").arg(AppName).arg(AppVersion).arg(d_ptr->renderWidget->glVersionString()));
-}
-
-
-MainWindow::~MainWindow()
-{
-    delete ui;
-}
-
-
-void MainWindow::restoreSettings(void)
-{
-    Q_D(MainWindow);
-    QSettings settings(Company, AppName);
-    restoreGeometry(settings.value("MainWindow/geometry").toByteArray());
-    ui->actionVisualizeGaze->setChecked(settings.value("MainWindow/visualizeGaze", true).toBool());
-    ui->actionAutoplayVideo->setChecked(settings.value("MainWindow/autoplayVideo", false).toBool());
-    d->lastOpenVideoDir = settings.value("MainWindow/lastOpenVideoDir").toString();
-    d->lastOpenGazeDataDir = settings.value("MainWindow/lastOpenGazeDataDir").toString();
-    d->currentVideoFilename = settings.value("MainWindow/lastVideoFilename").toString();
-    d->currentGazeDataFilename = settings.value("MainWindow/currentGazeDataFilename").toString();
-    if (!d->currentVideoFilename.isEmpty())
-        loadVideo(d->currentVideoFilename);
-    d->videoWidget->setVisualisation(ui->actionVisualizeGaze->isChecked());
-    d->renderWidget->restoreGeometry(settings.value("RenderWidget/geometry").toByteArray());
-    // d->renderWidget->setVisible(settings.value("RenderWidget/visible", true).toBool());
-    d->quiltWidget->restoreGeometry(settings.value("QuiltWidget/geometry").toByteArray());
-    // d->quiltWidget->setVisible(settings.value("QuiltWidget/visible", true).toBool());
-}
-
-
-void MainWindow::saveGazeData(void)
-{
-    Q_D(MainWindow);
-    if (d->gazeSamples.count() > 0) {
-        statusBar()->showMessage("Writing log file ...", 3000);
-        saveGazeData("gazeData.log");
-    }
-}
-
-
-void MainWindow::saveGazeData(const QString &filename)
-{
-    Q_D(MainWindow);
-    QFile logFile(filename);
-    logFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
-    foreach (Sample sample, d->gazeSamples)
-        logFile.write(QString("%1;%2;%3\n").arg(sample.timestamp).arg(sample.pos.x()).arg(sample.pos.y()).toLatin1());
-    logFile.close();
-}
-
-
-void MainWindow::saveSettings(void)
-{
-    Q_D(MainWindow);
-    QSettings settings(Company, AppName);
-    settings.setValue("MainWindow/geometry", saveGeometry());
-    settings.setValue("MainWindow/visualizeGaze", ui->actionVisualizeGaze->isChecked());
-    settings.setValue("MainWindow/autoplayVideo", ui->actionAutoplayVideo->isChecked());
-    settings.setValue("MainWindow/lastOpenVideoDir", d->lastOpenVideoDir);
-    settings.setValue("MainWindow/lastOpenGazeDataDir", d->lastOpenGazeDataDir);
-    settings.setValue("MainWindow/lastSaveDir", d->lastSaveDir);
-    settings.setValue("MainWindow/lastVideoFilename", d->currentVideoFilename);
-    settings.setValue("MainWindow/currentGazeDataFilename", d->currentGazeDataFilename);
-    settings.setValue("RenderWidget/geometry", d->renderWidget->saveGeometry());
-    settings.setValue("RenderWidget/visible", d->renderWidget->isVisible());
-    settings.setValue("QuiltWidget/geometry", d->quiltWidget->saveGeometry());
-    settings.setValue("QuiltWidget/visible", d->quiltWidget->isVisible());
-}
-
-
-void MainWindow::closeEvent(QCloseEvent *e)
-{
-    Q_D(MainWindow);
-    qDebug() << "MainWindow::closeEvent()";
-    d->decoderThread->abort();
-    d->renderWidget->close();
-    d->quiltWidget->close();
-    saveGazeData();
-    saveSettings();
-    QMainWindow::closeEvent(e);
-}
-
-
-void MainWindow::setVirtualGazePoint(const QPointF &relativePos)
-{
-    Q_D(MainWindow);
-    if (d->player->state() == QMediaPlayer::PlayingState)
-        d->gazeSamples.append(Sample(relativePos, d->player->position()));
-    d->renderWidget->setGazePoint(relativePos);
-}
-
-
-void MainWindow::addGazeSample(const Sample &sample)
-{
-    Q_D(MainWindow);
-    const QPoint &localPos = d->videoWidget->mapFromGlobal(sample.pos.toPoint());
-    const QPointF &relativePos = QPointF(
-                qreal(localPos.x()) / d->videoWidget->width(),
-                qreal(localPos.y()) / d->videoWidget->height());
-    if (d->player->state() == QMediaPlayer::PlayingState)
-        d->gazeSamples.append(Sample(relativePos, d->player->position()));
-    d->renderWidget->setGazePoint(relativePos);
-}
-
-
-void MainWindow::setFrame(const QImage &image, int frameCount)
-{
-    Q_D(MainWindow);
-    Q_UNUSED(frameCount);
-    if (d->gazeSamples.count() > 0) {
-        const Sample &currentSample = d->gazeSamples.last();
-        QPoint pos(currentSample.pos.x() * image.width() - d->quiltWidget->imageSize().width() / 2,
-                   currentSample.pos.y() * image.height() - d->quiltWidget->imageSize().height() / 2);
-        d->quiltWidget->addImage(image.copy(QRect(pos, d->quiltWidget->imageSize())));
-    }
-}
-
-
-void MainWindow::renderWidgetReady(void)
-{
-    qDebug() << "MainWindow::renderWidgetReady().";
-    updateWindowTitle();
-    loadGazeData("D:/Workspace/Eyex-Desktop_Qt_5_3_0_MSVC2012_OpenGL_32bit-Debug/gaze.log");
-    loadVideo("D:/Workspace/Eyex/samples/Cruel Intentions 720p 4 MBit.m4v");
-}
-
-
-void MainWindow::loadGazeData(const QString &filename)
-{
-    Q_D(MainWindow);
-    QFile f(filename);
-    f.open(QIODevice::Text | QIODevice::ReadOnly);
-    if (f.isReadable()) {
-        d->gazeSamples.empty();
-        while (!f.atEnd()) {
-            bool ok;
-            const QString &line = f.readLine();
-            if (line.isEmpty())
-                continue;
-            const QStringList &data = line.split(';');
-            if (data.count() != 3)
-                continue;
-            qint64 t = data.at(0).toLongLong(&ok);
-            if (!ok)
-                continue;
-            qreal x = data.at(1).toDouble(&ok);
-            if (!ok)
-                continue;
-            qreal y = data.at(2).toDouble(&ok);
-            if (!ok)
-                continue;
-            d->gazeSamples.append(Sample(QPointF(x, y), t));
-        }
-    }
-    f.close();
-    qDebug() << "loadGazeData() finished.";
-}
-
-
-void MainWindow::loadVideo(const QString &filename)
-{
-    Q_D(MainWindow);
-#if 0
-    d->decoderThread->abort();
-    bool ok = d->decoderThread->openVideo(filename);
-    if (ok)
-        d->decoderThread->start();
-#else
-    QUrl mediaFileUrl = QUrl::fromLocalFile(filename);
-    statusBar()->showMessage(tr("Loaded '%1'.").arg(mediaFileUrl.toString()), 5000);
-    d->playlist->clear();
-    d->playlist->addMedia(mediaFileUrl);
-    d->playlist->setCurrentIndex(0);
-    d->player->stop();
-    d->player->setPlaylist(d->playlist);
-    d->player->setMuted(true);
-    d->player->setVideoOutput(d->videoWidget->videoSurface());
-    d->videoWidget->setSamples(&d->gazeSamples);
-    d->playButton->setEnabled(true);
-    if (ui->actionAutoplayVideo->isChecked())
-        play();
-#endif
-}
-
-
-void MainWindow::openGazeData(void)
-{
-    Q_D(MainWindow);
-    QString filename = QFileDialog::getOpenFileName(this,
-                                                    tr("Open gaze data"),
-                                                    d->lastOpenGazeDataDir,
-                                                    tr("Gaze data files (*.*)"));
-    if(!filename.isNull()) {
-        QFileInfo fi(filename);
-        d->lastOpenGazeDataDir = fi.absolutePath();
-        loadGazeData(filename);
-    }
-}
-
-
-void MainWindow::openVideo(void)
-{
-    Q_D(MainWindow);
-    QString filename = QFileDialog::getOpenFileName(this,
-                                                    tr("Open video"),
-                                                    d->lastOpenVideoDir,
-                                                    tr("Video files (*.*)"));
-    if(!filename.isNull()) {
-        QFileInfo fi(filename);
-        d->lastOpenVideoDir = fi.absolutePath();
-        loadVideo(filename);
-    }
-}
-
-
-void MainWindow::positionChanged(qint64 position)
-{
-    Q_D(MainWindow);
-    // qDebug() << "MainWindow::positionChanged(" << position << ")";
-    d->positionSlider->setValue((int)position);
-}
-
-
-void MainWindow::durationChanged(qint64 duration)
-{
-    Q_D(MainWindow);
-    qDebug() << "MainWindow::durationChanged(" << duration << ")";
-    d->positionSlider->setMaximum((int)duration);
-}
-
-
-void MainWindow::play(void)
-{
-    Q_D(MainWindow);
-    switch(d->player->state()) {
-    case QMediaPlayer::PlayingState:
-        d->player->pause();
-        break;
-    default:
-        d->player->play();
-        break;
-    }
-}
-
-
-void MainWindow::mediaStateChanged(QMediaPlayer::State state)
-{
-    Q_D(MainWindow);
-    switch(state) {
-    case QMediaPlayer::PlayingState:
-        d->playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
-        break;
-    default:
-        d->playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
-        break;
-    }
-}
-
-
-void MainWindow::handleError(void)
-{
-    Q_D(MainWindow);
-    d->playButton->setEnabled(false);
-    statusBar()->showMessage(tr("Error: ").arg(d->player->errorString()));
-}
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QSettings>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QDateTime>
+#include <QSlider>
+#include <QAction>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QTimer>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QAbstractVideoSurface>
+
+#include "main.h"
+#include "sample.h"
+#include "gazelog.h"
+#include "gazerecorder.h"
+#include "gazeimporter.h"
+#include "gazestore.h"
+#include "gazeresampler.h"
+#include "mediaindex.h"
+#include "mediaindexer.h"
+#include "decoderthread.h"
+#include "playlistplayer.h"
+#include "streamgroup.h"
+#include "framecompositor.h"
+#include "framescheduler.h"
+#include "framebroadcaster.h"
+#include "yuvconverter.h"
+#include "renderwidget.h"
+#include "quiltwidget.h"
+#include "videowidget.h"
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include "eyexhost.h"
+
+class MainWindowPrivate {
+public:
+     // samples kept in memory while recording, about 10 s at the highest rates trackers deliver
+     static const int DefaultGazeWindowSamples = 12000;
+     // while the slider is dragged, seek at most this often
+     static const int SliderSeekIntervalMs = 100;
+     MainWindowPrivate()
+         : quiltWidget(new QuiltWidget)
+         , renderWidget(new RenderWidget)
+         , videoWidget(new VideoWidget)
+         , playlistPlayer(new PlaylistPlayer)
+         , decoderThread(playlistPlayer->current())
+         , frameScheduler(playlistPlayer->scheduler())
+         , frameBroadcaster(new FrameBroadcaster)
+         , streamGroup(new StreamGroup)
+         , frameCompositor(new FrameCompositor)
+         , ffmpegPlayback(false)
+         , multiStream(false)
+         , compositeStreams(true)
+         , gazeRecorder(new GazeRecorder)
+         , gazeRecorderFailed(false)
+         , gazeSessionClosed(false)
+         , gazeWindowSamples(DefaultGazeWindowSamples)
+         , gazeCursor(&gazeStore)
+         , replayAction(nullptr)
+         , sliderSeekPosition(0)
+     {
+         sliderSeekTimer.setSingleShot(true);
+         sliderSeekTimer.setInterval(SliderSeekIntervalMs);
+     }
+     ~MainWindowPrivate()
+     {
+         delete videoWidget;
+         delete renderWidget;
+         delete quiltWidget;
+         delete gazeRecorder;
+         qDeleteAll(streamWidgets);
+         delete frameCompositor;
+         delete streamGroup;
+         delete frameBroadcaster;
+         delete playlistPlayer;
+     }
+     Samples gazeSamples;
+     QVector<qint64> droppedFrames;
+     QuiltWidget *quiltWidget;
+     RenderWidget *renderWidget;
+     VideoWidget *videoWidget;
+     QPushButton *playButton;
+     QSlider *positionSlider;
+     QTimer sliderSeekTimer;
+     int sliderSeekPosition;
+     QLabel *decodeFpsLabel;
+     QLabel *presentationLabel;
+     QLabel *throughputLabel;
+     QString currentVideoFilename;
+     QString lastOpenVideoDir;
+     QString currentGazeDataFilename;
+     QString lastOpenGazeDataDir;
+     QString lastSaveDir;
+     PlaylistPlayer *playlistPlayer;
+     // the playlist player's active decoder
+     DecoderThread *decoderThread;
+     FrameScheduler *frameScheduler;
+     FrameBroadcaster *frameBroadcaster;
+     StreamGroup *streamGroup;
+     FrameCompositor *frameCompositor;
+     // one window per additional stream if the streams aren't composited
+     QList<RenderWidget *> streamWidgets;
+     bool ffmpegPlayback;
+     bool multiStream;
+     bool compositeStreams;
+     GazeRecorder *gazeRecorder;
+     bool gazeRecorderFailed;
+     // set once the session's log has been finished, no samples are recorded after that
+     bool gazeSessionClosed;
+     int gazeWindowSamples;
+     // a loaded recording being replayed along with the video
+     GazeStore gazeStore;
+     GazeStore::Cursor gazeCursor;
+     // checked while the loaded recording is replayed instead of the live gaze
+     QAction *replayAction;
+     GazeResampler gazeResampler;
+     // the replayed recording resampled onto the current video's frames
+     QSharedPointer<const FrameGaze> frameGaze;
+     // writes the frame timestamps of videos that have no media index yet
+     MediaIndexer mediaIndexer;
+};
+
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow)
+    , d_ptr(new MainWindowPrivate())
+{
+    Q_D(MainWindow);
+    ui->setupUi(this);
+    setWindowTitle(tr("%1 %2").arg(AppName).arg(AppVersion));
+
+    d->playButton = new QPushButton;
+    d->playButton->setEnabled(false);
+    d->playButton->setMinimumWidth(50);
+    d->playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+
+    d->positionSlider = new QSlider(Qt::Horizontal);
+    d->positionSlider->setRange(0, 100);
+
+    QAction *stepForwardAction = new QAction(tr("Step forward"), this);
+    stepForwardAction->setShortcut(QKeySequence(Qt::Key_Period));
+    addAction(stepForwardAction);
+    QAction *stepBackwardAction = new QAction(tr("Step backward"), this);
+    stepBackwardAction->setShortcut(QKeySequence(Qt::Key_Comma));
+    addAction(stepBackwardAction);
+    QAction *fasterAction = new QAction(tr("Faster"), this);
+    fasterAction->setShortcut(QKeySequence(Qt::Key_BracketRight));
+    addAction(fasterAction);
+    QAction *slowerAction = new QAction(tr("Slower"), this);
+    slowerAction->setShortcut(QKeySequence(Qt::Key_BracketLeft));
+    addAction(slowerAction);
+    QAction *reverseAction = new QAction(tr("Reverse"), this);
+    reverseAction->setShortcut(QKeySequence(Qt::Key_R));
+    addAction(reverseAction);
+    d->replayAction = new QAction(tr("Replay gaze data"), this);
+    d->replayAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_R));
+    d->replayAction->setCheckable(true);
+    d->replayAction->setEnabled(false);
+    addAction(d->replayAction);
+    QAction *unloadGazeDataAction = new QAction(tr("Unload gaze data"), this);
+    unloadGazeDataAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_U));
+    addAction(unloadGazeDataAction);
+    QAction *exportGazeDataAction = new QAction(tr("Export gaze data as text ..."), this);
+    exportGazeDataAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_E));
+    addAction(exportGazeDataAction);
+    QAction *exportFrameGazeAction = new QAction(tr("Export gaze per frame ..."), this);
+    exportFrameGazeAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_F));
+    addAction(exportFrameGazeAction);
+    QAction *openSyncedVideosAction = new QAction(tr("Open synchronised videos ..."), this);
+    openSyncedVideosAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_O));
+    addAction(openSyncedVideosAction);
+
+    d->decodeFpsLabel = new QLabel;
+    statusBar()->addPermanentWidget(d->decodeFpsLabel);
+    d->presentationLabel = new QLabel;
+    statusBar()->addPermanentWidget(d->presentationLabel);
+    d->throughputLabel = new QLabel;
+    statusBar()->addPermanentWidget(d->throughputLabel);
+
+    QBoxLayout *controlLayout = new QHBoxLayout;
+    controlLayout->setMargin(0);
+    controlLayout->addWidget(d->playButton);
+    controlLayout->addWidget(d->positionSlider);
+
+    QObject::connect(EyeXHost::instance(), SIGNAL(gazeSampleReady(Sample)), SLOT(addGazeSample(Sample)));
+    qDebug() << "YUV to RGB conversion kernel:" << YUVConverter::kernelName();
+    // frames are decoded at the largest size they are displayed at
+    foreach (DecoderThread *decoder, d->playlistPlayer->decoders()) {
+        decoder->setConsumerResolution("render", d->renderWidget->targetSize());
+        decoder->setConsumerResolution("video", d->videoWidget->size());
+    }
+    QObject::connect(d->renderWidget, SIGNAL(targetSizeChanged(QSize)), SLOT(renderTargetSizeChanged(QSize)));
+    QObject::connect(d->videoWidget, SIGNAL(targetSizeChanged(QSize)), SLOT(videoTargetSizeChanged(QSize)));
+    // whichever player is active publishes its frames, the video widget, the foveated renderer
+    // and the quilt only ever look at the latest one so that none can hold up the others
+    d->frameBroadcaster->subscribe("video", FrameBroadcaster::LatestOnly);
+    d->frameBroadcaster->subscribe("render", FrameBroadcaster::LatestOnly);
+    d->frameBroadcaster->subscribe("quilt", FrameBroadcaster::LatestOnly);
+    d->videoWidget->setSamples(&d->gazeSamples);
+    QObject::connect(d->frameScheduler, SIGNAL(frameReady(VideoFrame)), d->frameBroadcaster, SLOT(publish(VideoFrame)));
+    QObject::connect(d->frameBroadcaster, SIGNAL(frameAvailable(QString)), SLOT(frameAvailable(QString)), Qt::QueuedConnection);
+    QObject::connect(d->frameScheduler, SIGNAL(framePresented(qint64, qint64)), SLOT(positionChanged(qint64)));
+    QObject::connect(d->frameScheduler, SIGNAL(deviationChanged(qreal, qreal, qreal)), SLOT(presentationDeviationChanged(qreal, qreal, qreal)));
+    attachDecoder(d->decoderThread);
+    QObject::connect(d->streamGroup, SIGNAL(streamCreated(DecoderThread*)), SLOT(applyDecoderSettings(DecoderThread*)));
+    QObject::connect(d->streamGroup, SIGNAL(frameReady(int, VideoFrame)), SLOT(streamFrameReady(int, VideoFrame)));
+    QObject::connect(d->streamGroup, SIGNAL(positionChanged(qint64)), SLOT(positionChanged(qint64)));
+    QObject::connect(d->streamGroup, SIGNAL(durationChanged(qint64)), SLOT(durationChanged(qint64)));
+    QObject::connect(d->frameCompositor, SIGNAL(frameReady(VideoFrame)), d->frameBroadcaster, SLOT(publish(VideoFrame)));
+    QObject::connect(d->playlistPlayer, SIGNAL(currentChanged(int, DecoderThread*, DecoderThread*)), SLOT(currentClipChanged(int, DecoderThread*, DecoderThread*)));
+    QObject::connect(d->playlistPlayer, SIGNAL(clipSwitched(int, qint64)), SLOT(clipSwitched(int, qint64)));
+    QObject::connect(d->positionSlider, SIGNAL(sliderMoved(int)), SLOT(sliderMoved(int)));
+    QObject::connect(d->positionSlider, SIGNAL(sliderReleased()), SLOT(sliderReleased()));
+    QObject::connect(&d->sliderSeekTimer, SIGNAL(timeout()), SLOT(seekToSliderPosition()));
+    QObject::connect(stepForwardAction, SIGNAL(triggered()), SLOT(stepFrameForward()));
+    QObject::connect(stepBackwardAction, SIGNAL(triggered()), SLOT(stepFrameBackward()));
+    QObject::connect(fasterAction, SIGNAL(triggered()), SLOT(faster()));
+    QObject::connect(slowerAction, SIGNAL(triggered()), SLOT(slower()));
+    QObject::connect(reverseAction, SIGNAL(triggered()), SLOT(reverse()));
+    QObject::connect(openSyncedVideosAction, SIGNAL(triggered()), SLOT(openSyncedVideos()));
+    QObject::connect(d->replayAction, SIGNAL(toggled(bool)), SLOT(setGazeReplay(bool)));
+    QObject::connect(unloadGazeDataAction, SIGNAL(triggered()), SLOT(unloadGazeData()));
+    QObject::connect(&d->mediaIndexer, SIGNAL(finished()), SLOT(mediaIndexed()));
+    QObject::connect(exportGazeDataAction, SIGNAL(triggered()), SLOT(exportGazeData()));
+    QObject::connect(exportFrameGazeAction, SIGNAL(triggered()), SLOT(exportFrameGaze()));
+    QObject::connect(d->renderWidget, SIGNAL(ready()), SLOT(renderWidgetReady()));
+    QObject::connect(d->videoWidget, SIGNAL(virtualGazePointChanged(QPointF)), SLOT(setVirtualGazePoint(QPointF)));
+
+    QObject::connect(ui->actionVisualizeGaze, SIGNAL(toggled(bool)), d->videoWidget, SLOT(setVisualisation(bool)));
+    QObject::connect(ui->actionOpenVideo, SIGNAL(triggered()), SLOT(openVideo()));
+    QObject::connect(ui->actionOpenGazeData, SIGNAL(triggered()), SLOT(openGazeData()));
+    QObject::connect(ui->actionExit, SIGNAL(triggered()), SLOT(close()));
+
+    ui->presentGridLayout->addWidget(d->videoWidget, 0, 0);
+    ui->presentGridLayout->addLayout(controlLayout, 1, 0);
+    d->videoWidget->show();
+    d->renderWidget->show();
+    d->quiltWidget->show();
+
+    QObject::connect(d->playButton, SIGNAL(clicked()), SLOT(play()));
+
+    restoreSettings();    
+}
+
+
+void MainWindow::updateWindowTitle(void)
+{
+    setWindowTitle(tr("%1 %2 (OpenGL %3)").arg(AppName).arg(AppVersion).arg(d_ptr->renderWidget->glVersionString()));
+}
+
+
+MainWindow::~MainWindow()
+{
+    delete ui;
+}
+
+
+void MainWindow::restoreSettings(void)
+{
+    Q_D(MainWindow);
+    QSettings settings(Company, AppName);
+    restoreGeometry(settings.value("MainWindow/geometry").toByteArray());
+    ui->actionVisualizeGaze->setChecked(settings.value("MainWindow/visualizeGaze", true).toBool());
+    ui->actionAutoplayVideo->setChecked(settings.value("MainWindow/autoplayVideo", false).toBool());
+    d->lastOpenVideoDir = settings.value("MainWindow/lastOpenVideoDir").toString();
+    d->lastOpenGazeDataDir = settings.value("MainWindow/lastOpenGazeDataDir").toString();
+    d->lastSaveDir = settings.value("MainWindow/lastSaveDir").toString();
+    d->currentVideoFilename = settings.value("MainWindow/lastVideoFilename").toString();
+    d->currentGazeDataFilename = settings.value("MainWindow/currentGazeDataFilename").toString();
+    d->compositeStreams = settings.value("MultiStream/layout", "grid").toString() != "separate";
+    d->gazeRecorder->setFlushInterval(settings.value("GazeRecorder/flushIntervalMs", GazeRecorder::DefaultFlushIntervalMs).toInt());
+    d->gazeWindowSamples = qMax(1, settings.value("GazeRecorder/windowSamples", MainWindowPrivate::DefaultGazeWindowSamples).toInt());
+    foreach (DecoderThread *decoder, d->playlistPlayer->decoders())
+        applyDecoderSettings(decoder);
+    if (!d->currentVideoFilename.isEmpty())
+        loadVideo(d->currentVideoFilename);
+    d->videoWidget->setVisualisation(ui->actionVisualizeGaze->isChecked());
+    d->renderWidget->restoreGeometry(settings.value("RenderWidget/geometry").toByteArray());
+    // d->renderWidget->setVisible(settings.value("RenderWidget/visible", true).toBool());
+    d->quiltWidget->restoreGeometry(settings.value("QuiltWidget/geometry").toByteArray());
+    // d->quiltWidget->setVisible(settings.value("QuiltWidget/visible", true).toBool());
+}
+
+
+// Applies the Decoder/* settings, also to the decoders of synchronised streams.
+void MainWindow::applyDecoderSettings(DecoderThread *decoder)
+{
+    QSettings settings(Company, AppName);
+    decoder->setDecoderThreads(
+                settings.value("Decoder/threadCount", 0).toInt(),
+                settings.value("Decoder/threadType", "frame").toString() == "slice"
+                ? DecoderThread::SliceThreading
+                : DecoderThread::FrameThreading);
+    decoder->setFrameCacheBudget(Q_INT64_C(1024) * 1024 * settings.value("Decoder/frameCacheMB", FrameCache::DefaultBudget / 1024 / 1024).toLongLong());
+    decoder->setPrefetchFrames(settings.value("Decoder/prefetchFrames", DecoderThread::DefaultPrefetchFrames).toInt());
+    decoder->setAdaptiveDropping(settings.value("Decoder/adaptiveDropping", true).toBool());
+    const QString &inputMode = settings.value("Decoder/inputMode", "auto").toString();
+    decoder->setInputMode(
+                inputMode == "mmap" ? MediaInput::Mapped : inputMode == "readahead" ? MediaInput::ReadAhead : MediaInput::Auto,
+                1024 * 1024 * settings.value("Decoder/readAheadMB", MediaInput::DefaultReadAheadWindow / 1024 / 1024).toInt());
+    decoder->setPreload(
+                settings.value("Decoder/preload", false).toBool(),
+                1000 * settings.value("Decoder/preloadMaxSeconds", DecoderThread::DefaultPreloadMaxMs / 1000).toLongLong(),
+                settings.value("Decoder/preloadCompressed", false).toBool(),
+                Q_INT64_C(1024) * 1024 * settings.value("Decoder/preloadMaxMB", DecoderThread::DefaultPreloadMaxMB).toLongLong());
+}
+
+
+// The recorder has been writing the gaze data all along, so it only needs to finish the log.
+void MainWindow::saveGazeData(void)
+{
+    Q_D(MainWindow);
+    d->gazeSessionClosed = true;
+    d->gazeRecorder->close();
+    if (d->droppedFrames.count() > 0 && !d->currentVideoFilename.isEmpty())
+        saveDroppedFrames(d->currentVideoFilename + ".dropped.log");
+}
+
+
+// Hands the sample to the recorder, which is started with the first one.
+// Every session gets a log of its own, named after the time it started.
+// Only a window of the most recent samples stays in memory.
+void MainWindow::recordGazeSample(const Sample &sample)
+{
+    Q_D(MainWindow);
+    if (d->gazeSessionClosed)
+        return;
+    if (!d->gazeRecorder->isRecording() && !d->gazeRecorderFailed) {
+        GazeLog::Info info;
+        info.device = "Tobii EyeX";
+        info.coordinateSpace = GazeLog::VideoRelative;
+        const QString &filename = QString("gazeData-%1.dvgaze").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+        d->gazeRecorderFailed = !d->gazeRecorder->open(filename, info);
+        if (d->gazeRecorderFailed)
+            statusBar()->showMessage(tr("Cannot record gaze data."), 5000);
+    }
+    d->gazeRecorder->append(sample);
+    d->gazeSamples.append(sample);
+    // trimmed in chunks so that the vector isn't shifted on every sample
+    if (d->gazeSamples.count() > 2 * d->gazeWindowSamples)
+        d->gazeSamples.remove(0, d->gazeSamples.count() - d->gazeWindowSamples);
+}
+
+
+// Writes the timestamps of all frames the decoder dropped, one per line,
+// so that gaze samples falling on them can be left out of the analysis.
+// The log goes next to the video it belongs to.
+void MainWindow::saveDroppedFrames(const QString &filename)
+{
+    Q_D(MainWindow);
+    QSaveFile logFile(filename);
+    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "MainWindow: cannot write" << filename;
+        return;
+    }
+    foreach (qint64 pts, d->droppedFrames)
+        logFile.write(QString("%1\n").arg(pts).toLatin1());
+    if (!logFile.commit())
+        qWarning() << "MainWindow: cannot write" << filename;
+}
+
+
+void MainWindow::saveSettings(void)
+{
+    Q_D(MainWindow);
+    QSettings settings(Company, AppName);
+    settings.setValue("MainWindow/geometry", saveGeometry());
+    settings.setValue("MainWindow/visualizeGaze", ui->actionVisualizeGaze->isChecked());
+    settings.setValue("MainWindow/autoplayVideo", ui->actionAutoplayVideo->isChecked());
+    settings.setValue("MainWindow/lastOpenVideoDir", d->lastOpenVideoDir);
+    settings.setValue("MainWindow/lastOpenGazeDataDir", d->lastOpenGazeDataDir);
+    settings.setValue("MainWindow/lastSaveDir", d->lastSaveDir);
+    settings.setValue("MainWindow/lastVideoFilename", d->currentVideoFilename);
+    settings.setValue("MainWindow/currentGazeDataFilename", d->currentGazeDataFilename);
+    settings.setValue("MultiStream/layout", d->compositeStreams ? "grid" : "separate");
+    settings.setValue("GazeRecorder/flushIntervalMs", d->gazeRecorder->flushInterval());
+    settings.setValue("GazeRecorder/windowSamples", d->gazeWindowSamples);
+    settings.setValue("Decoder/threadCount", d->decoderThread->decoderThreadCount());
+    settings.setValue("Decoder/threadType", d->decoderThread->decoderThreadType() == DecoderThread::SliceThreading ? "slice" : "frame");
+    settings.setValue("Decoder/frameCacheMB", d->decoderThread->frameCache()->budget() / 1024 / 1024);
+    settings.setValue("Decoder/prefetchFrames", d->decoderThread->prefetchFrames());
+    settings.setValue("Decoder/adaptiveDropping", d->decoderThread->adaptiveDropping());
+    const MediaInput::Mode inputMode = d->decoderThread->inputMode();
+    settings.setValue("Decoder/inputMode", inputMode == MediaInput::Mapped ? "mmap" : inputMode == MediaInput::ReadAhead ? "readahead" : "auto");
+    settings.setValue("Decoder/readAheadMB", d->decoderThread->mediaInput()->readAheadWindow() / 1024 / 1024);
+    settings.setValue("Decoder/preload", d->decoderThread->preloadEnabled());
+    settings.setValue("Decoder/preloadMaxSeconds", d->decoderThread->preloadMaxDuration() / 1000);
+    settings.setValue("Decoder/preloadCompressed", d->decoderThread->preloadCompressed());
+    settings.setValue("Decoder/preloadMaxMB", d->decoderThread->preloadMaxBytes() / 1024 / 1024);
+    settings.setValue("RenderWidget/geometry", d->renderWidget->saveGeometry());
+    settings.setValue("RenderWidget/visible", d->renderWidget->isVisible());
+    settings.setValue("QuiltWidget/geometry", d->quiltWidget->saveGeometry());
+    settings.setValue("QuiltWidget/visible", d->quiltWidget->isVisible());
+}
+
+
+void MainWindow::closeEvent(QCloseEvent *e)
+{
+    Q_D(MainWindow);
+    qDebug() << "MainWindow::closeEvent()";
+    d->playlistPlayer->abort();
+    closeSyncedVideos();
+    d->renderWidget->close();
+    d->quiltWidget->close();
+    saveGazeData();
+    saveSettings();
+    QMainWindow::closeEvent(e);
+}
+
+
+void MainWindow::setVirtualGazePoint(const QPointF &relativePos)
+{
+    Q_D(MainWindow);
+    if (isPlaying())
+        recordGazeSample(Sample(relativePos, playbackPosition()));
+    d->renderWidget->setGazePoint(relativePos);
+}
+
+
+void MainWindow::addGazeSample(const Sample &sample)
+{
+    Q_D(MainWindow);
+    const QPoint &localPos = d->videoWidget->mapFromGlobal(sample.pos.toPoint());
+    const QPointF &relativePos = QPointF(
+                qreal(localPos.x()) / d->videoWidget->width(),
+                qreal(localPos.y()) / d->videoWidget->height());
+    if (isPlaying())
+        recordGazeSample(Sample(relativePos, playbackPosition()));
+    // while a recording is replayed, the renderer follows that instead
+    if (!isReplayingGaze())
+        d->renderWidget->setGazePoint(relativePos);
+}
+
+
+bool MainWindow::isPlaying(void) const
+{
+    if (d_ptr->multiStream)
+        return !d_ptr->streamGroup->isPaused() && d_ptr->streamGroup->stream(0)->presentationClock()->isValid();
+    if (d_ptr->ffmpegPlayback)
+        return !d_ptr->playlistPlayer->isPaused() && d_ptr->playlistPlayer->current()->presentationClock()->isValid();
+    return false;
+}
+
+
+// Media time of what is on screen right now. That is the presentation
+// clock's time rather than the last frame's timestamp, so that gaze
+// samples arriving between two frames keep their spacing.
+qint64 MainWindow::playbackPosition(void) const
+{
+    if (d_ptr->multiStream)
+        return d_ptr->streamGroup->stream(0)->presentationClock()->time();
+    if (d_ptr->ffmpegPlayback)
+        return d_ptr->playlistPlayer->current()->presentationClock()->time();
+    return 0;
+}
+
+
+void MainWindow::setFrame(const VideoFrame &frame)
+{
+    Q_D(MainWindow);
+    if (frame.isNull())
+        return;
+    Sample currentSample;
+    const bool replay = isReplayingGaze();
+    const int f = (!replay || d->frameGaze.isNull()) ? -1 : d->frameGaze->frameAt(frame.pts);
+    if (f >= 0 && d->frameGaze->count.at(f) > 0) {
+        // the median of the frame's samples is less jittery than any single one of them
+        currentSample = Sample(QPointF(d->frameGaze->medianX.at(f), d->frameGaze->medianY.at(f)), frame.pts);
+        d->renderWidget->setGazePoint(currentSample.pos);
+        d->videoWidget->setGazeTime(frame.pts);
+    }
+    else if (replay) {
+        // a replayed recording has a sample for the frame's time, not just a latest one
+        currentSample = d->gazeStore.sample(d->gazeCursor.nearest(frame.pts));
+        d->renderWidget->setGazePoint(currentSample.pos);
+        d->videoWidget->setGazeTime(frame.pts);
+    }
+    else if (d->gazeSamples.count() > 0) {
+        currentSample = d->gazeSamples.last();
+    }
+    else {
+        return;
+    }
+    // only the patch around the gaze point gets converted (or copied, if the frame is RGB already)
+    QPoint pos(currentSample.pos.x() * frame.size().width() - d->quiltWidget->imageSize().width() / 2,
+               currentSample.pos.y() * frame.size().height() - d->quiltWidget->imageSize().height() / 2);
+    d->quiltWidget->addImage(YUVConverter::toImage(frame, QRect(pos, d->quiltWidget->imageSize())));
+}
+
+
+void MainWindow::frameAvailable(const QString &subscriber)
+{
+    Q_D(MainWindow);
+    VideoFrame frame;
+    if (!d->frameBroadcaster->tryPop(subscriber, frame))
+        return;
+    if (subscriber == "video")
+        d->videoWidget->setFrame(frame);
+    else if (subscriber == "render")
+        d->renderWidget->setFrame(frame);
+    else if (subscriber == "quilt")
+        setFrame(frame);
+}
+
+
+void MainWindow::renderTargetSizeChanged(const QSize &size)
+{
+    Q_D(MainWindow);
+    foreach (DecoderThread *decoder, d->playlistPlayer->decoders())
+        decoder->setConsumerResolution("render", size);
+    if (d->multiStream && !d->compositeStreams)
+        d->streamGroup->stream(0)->setConsumerResolution("render", size);
+}
+
+
+void MainWindow::videoTargetSizeChanged(const QSize &size)
+{
+    Q_D(MainWindow);
+    foreach (DecoderThread *decoder, d->playlistPlayer->decoders())
+        decoder->setConsumerResolution("video", size);
+    if (d->multiStream && !d->compositeStreams)
+        d->streamGroup->stream(0)->setConsumerResolution("video", size);
+}
+
+
+void MainWindow::renderWidgetReady(void)
+{
+    qDebug() << "MainWindow::renderWidgetReady().";
+    updateWindowTitle();
+    // loaded for inspection and export, the live gaze keeps driving the view until replay is switched on
+    loadGazeData("D:/Workspace/Eyex-Desktop_Qt_5_3_0_MSVC2012_OpenGL_32bit-Debug/gaze.log", false);
+    loadVideo("D:/Workspace/Eyex/samples/Cruel Intentions 720p 4 MBit.m4v");
+}
+
+
+// Loads a recording into the gaze store. With `replay` set it takes over
+// from the live gaze right away, otherwise once replay is switched on.
+void MainWindow::loadGazeData(const QString &filename, bool replay)
+{
+    Q_D(MainWindow);
+    bool ok;
+    GazeColumns columns;
+    GazeLog::CoordinateSpace space = GazeLog::VideoRelative;
+    if (GazeLog::isGazeLog(filename)) {
+        GazeLog log;
+        ok = log.load(filename);
+        if (ok) {
+            columns = log.columns();
+            space = log.info().coordinateSpace;
+        }
+    }
+    else {
+        GazeImporter importer;
+        ok = importer.import(filename);
+        if (ok) {
+            columns = importer.columns();
+            space = importer.coordinateSpace();
+            if (importer.malformedLines() > 0)
+                statusBar()->showMessage(tr("%1 malformed lines in '%2', the first one is line %3.")
+                                         .arg(importer.malformedLines()).arg(filename).arg(importer.firstMalformedLine()), 10000);
+        }
+    }
+    if (!ok) {
+        statusBar()->showMessage(tr("Cannot load gaze data from '%1'.").arg(filename), 5000);
+        return;
+    }
+    if (!toVideoRelative(columns, space)) {
+        statusBar()->showMessage(tr("The gaze points in '%1' are in pixels of the video. Please load the video first.").arg(filename), 5000);
+        return;
+    }
+    d->gazeStore.setColumns(columns);
+    d->gazeCursor.reset();
+    d->gazeResampler.invalidateLog(filename);
+    d->currentGazeDataFilename = filename;
+    updateFrameGaze();
+    d->replayAction->setEnabled(true);
+    d->replayAction->setChecked(replay);
+    // toggled() isn't emitted if the state stays the same
+    setGazeReplay(replay);
+    qDebug() << "loadGazeData() finished:" << d->gazeStore.count() << "samples.";
+}
+
+
+bool MainWindow::isReplayingGaze(void) const
+{
+    return d_ptr->replayAction->isChecked() && !d_ptr->gazeStore.isEmpty();
+}
+
+
+void MainWindow::setGazeReplay(bool replay)
+{
+    Q_D(MainWindow);
+    d->gazeCursor.reset();
+    d->videoWidget->setGazeStore(replay && !d->gazeStore.isEmpty() ? &d->gazeStore : nullptr);
+}
+
+
+// Drops the loaded recording, the live gaze takes over again.
+void MainWindow::unloadGazeData(void)
+{
+    Q_D(MainWindow);
+    d->gazeResampler.invalidateLog(d->currentGazeDataFilename);
+    d->gazeStore.clear();
+    d->frameGaze.clear();
+    d->currentGazeDataFilename.clear();
+    d->replayAction->setChecked(false);
+    d->replayAction->setEnabled(false);
+    setGazeReplay(false);
+}
+
+
+// Converts gaze points given in pixels to fractions of the video. Screen
+// pixels are related to the video as Tobii software presents it: full
+// screen with its aspect ratio kept. Fails if the points are in pixels of
+// a video whose size isn't known yet.
+bool MainWindow::toVideoRelative(GazeColumns &columns, GazeLog::CoordinateSpace space)
+{
+    Q_D(MainWindow);
+    if (space == GazeLog::VideoRelative)
+        return true;
+    const QSizeF videoSize = d->multiStream
+            ? d->streamGroup->stream(0)->videoSize()
+            : d->ffmpegPlayback ? d->decoderThread->videoSize() : QSize();
+    QRectF area(QPointF(0, 0), videoSize);
+    if (space == GazeLog::ScreenPixels) {
+        const QScreen *screen = QGuiApplication::primaryScreen();
+        const QSizeF screenSize = QSizeF(screen->size()) * screen->devicePixelRatio();
+        const QSizeF shown = videoSize.isEmpty() ? screenSize : videoSize.scaled(screenSize, Qt::KeepAspectRatio);
+        area = QRectF(QPointF((screenSize.width() - shown.width()) / 2, (screenSize.height() - shown.height()) / 2), shown);
+    }
+    if (area.isEmpty())
+        return false;
+    for (int i = 0; i < columns.count(); ++i) {
+        columns.x[i] = (columns.x.at(i) - area.left()) / area.width();
+        columns.y[i] = (columns.y.at(i) - area.top()) / area.height();
+    }
+    return true;
+}
+
+
+void MainWindow::loadVideo(const QString &filename)
+{
+    loadVideos(QStringList() << filename);
+}
+
+
+// Plays the given videos one after the other.
+void MainWindow::loadVideos(const QStringList &filenames)
+{
+    Q_D(MainWindow);
+    closeSyncedVideos();
+    d->currentVideoFilename = filenames.first();
+    updateFrameGaze();
+    d->droppedFrames.clear();
+    d->playlistPlayer->setPlaylist(filenames);
+    const bool ok = d->playlistPlayer->play(0, !ui->actionAutoplayVideo->isChecked());
+    d->ffmpegPlayback = ok;
+    d->playButton->setEnabled(ok);
+    if (!ok) {
+        statusBar()->showMessage(tr("Cannot open '%1'.").arg(filenames.first()), 5000);
+        return;
+    }
+    statusBar()->showMessage(tr("Loaded '%1'.").arg(filenames.join("', '")), 5000);
+    d->playButton->setIcon(style()->standardIcon(d->playlistPlayer->isPaused() ? QStyle::SP_MediaPlay : QStyle::SP_MediaPause));
+}
+
+
+void MainWindow::openGazeData(void)
+{
+    Q_D(MainWindow);
+    QString filename = QFileDialog::getOpenFileName(this,
+                                                    tr("Open gaze data"),
+                                                    d->lastOpenGazeDataDir,
+                                                    tr("Gaze data files (*.*)"));
+    if(!filename.isNull()) {
+        QFileInfo fi(filename);
+        d->lastOpenGazeDataDir = fi.absolutePath();
+        loadGazeData(filename);
+    }
+}
+
+
+void MainWindow::exportGazeData(void)
+{
+    Q_D(MainWindow);
+    // the replayed recording, or else all of this session's, not just the window kept in memory
+    Samples samples;
+    if (isReplayingGaze()) {
+        samples = d->gazeStore.columns().toSamples();
+    }
+    else if (!d->gazeRecorder->filename().isEmpty()) {
+        // a log still being recorded is read like one left unfinished
+        GazeLog log;
+        if (log.load(d->gazeRecorder->filename()))
+            samples = log.samples();
+    }
+    if (samples.isEmpty()) {
+        statusBar()->showMessage(tr("There is no gaze data to export."), 5000);
+        return;
+    }
+    const QString &filename = QFileDialog::getSaveFileName(this,
+                                                           tr("Export gaze data as text"),
+                                                           d->lastSaveDir,
+                                                           tr("Text gaze logs (*.log *.txt)"));
+    if (filename.isNull())
+        return;
+    d->lastSaveDir = QFileInfo(filename).absolutePath();
+    if (!GazeLog::exportText(filename, samples))
+        statusBar()->showMessage(tr("Cannot write '%1'.").arg(filename), 5000);
+}
+
+
+// Writes mean, median and dispersion of the replayed gaze for every frame of the video.
+void MainWindow::exportFrameGaze(void)
+{
+    Q_D(MainWindow);
+    if (d->frameGaze.isNull()) {
+        statusBar()->showMessage(tr("Load gaze data and an indexed video first."), 5000);
+        return;
+    }
+    const QString &filename = QFileDialog::getSaveFileName(this,
+                                                           tr("Export gaze per frame"),
+                                                           d->lastSaveDir,
+                                                           tr("Text files (*.csv *.txt)"));
+    if (filename.isNull())
+        return;
+    d->lastSaveDir = QFileInfo(filename).absolutePath();
+    QSaveFile f(filename);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        statusBar()->showMessage(tr("Cannot write '%1'.").arg(filename), 5000);
+        return;
+    }
+    const FrameGaze &fg = *d->frameGaze;
+    f.write("frame;pts;samples;meanX;meanY;medianX;medianY;dispersion\n");
+    for (int i = 0; i < fg.frameCount(); ++i) {
+        f.write(QString("%1;%2;%3;%4;%5;%6;%7;%8\n")
+                .arg(i).arg(fg.pts.at(i)).arg(fg.count.at(i))
+                .arg(fg.meanX.at(i)).arg(fg.meanY.at(i))
+                .arg(fg.medianX.at(i)).arg(fg.medianY.at(i))
+                .arg(fg.dispersion.at(i)).toLatin1());
+    }
+    if (!f.commit())
+        statusBar()->showMessage(tr("Cannot write '%1'.").arg(filename), 5000);
+}
+
+
+// Resamples the replayed recording onto the frames of the current video.
+// The frame timestamps come from the video's media index. If there is
+// none yet, it is built in the background and the resampling repeated
+// once it's there, see mediaIndexed(). The timestamps are shifted so that
+// the first frame is at 0, which is where players put it and where the
+// gaze recorded along with them starts.
+void MainWindow::updateFrameGaze(void)
+{
+    Q_D(MainWindow);
+    d->frameGaze.clear();
+    if (d->gazeStore.isEmpty() || d->currentVideoFilename.isEmpty())
+        return;
+    d->frameGaze = d->gazeResampler.frameGaze(d->currentGazeDataFilename, d->currentVideoFilename);
+    if (!d->frameGaze.isNull())
+        return;
+    MediaIndex index;
+    if (!index.load(d->currentVideoFilename) || index.frameCount() == 0) {
+        if (d->mediaIndexer.filename() != d->currentVideoFilename || !d->mediaIndexer.isRunning())
+            d->mediaIndexer.index(d->currentVideoFilename);
+        return;
+    }
+    const MediaIndex::StreamInfo &si = index.streamInfo();
+    if (si.timeBaseDen == 0 || si.frameRateNum == 0)
+        return;
+    QVector<qint64> framePts(int(index.frameCount()));
+    for (int i = 0; i < framePts.count(); ++i)
+        framePts[i] = qRound64(1000.0 * (index.framePts()[i] - si.startPts) * si.timeBaseNum / si.timeBaseDen);
+    d->frameGaze = d->gazeResampler.frameGaze(d->currentGazeDataFilename, d->currentVideoFilename,
+                                              d->gazeStore.columns(), framePts,
+                                              qMax(Q_INT64_C(1), qint64(1000) * si.frameRateDen / si.frameRateNum));
+}
+
+
+void MainWindow::mediaIndexed(void)
+{
+    Q_D(MainWindow);
+    // an aborted run reports in after its successor has started
+    if (d->mediaIndexer.isRunning())
+        return;
+    if (!d->mediaIndexer.succeeded()) {
+        statusBar()->showMessage(tr("Cannot index '%1', gaze isn't resampled onto its frames.").arg(d->mediaIndexer.filename()), 5000);
+        return;
+    }
+    if (d->mediaIndexer.filename() == d->currentVideoFilename)
+        updateFrameGaze();
+}
+
+
+void MainWindow::openVideo(void)
+{
+    Q_D(MainWindow);
+    const QStringList &filenames = QFileDialog::getOpenFileNames(this,
+                                                                 tr("Open video"),
+                                                                 d->lastOpenVideoDir,
+                                                                 tr("Video files (*.*)"));
+    if(!filenames.isEmpty()) {
+        QFileInfo fi(filenames.first());
+        d->lastOpenVideoDir = fi.absolutePath();
+        loadVideos(filenames);
+    }
+}
+
+
+void MainWindow::openSyncedVideos(void)
+{
+    Q_D(MainWindow);
+    const QStringList &filenames = QFileDialog::getOpenFileNames(this,
+                                                                 tr("Open synchronised videos"),
+                                                                 d->lastOpenVideoDir,
+                                                                 tr("Video files (*.*)"));
+    if(!filenames.isEmpty()) {
+        QFileInfo fi(filenames.first());
+        d->lastOpenVideoDir = fi.absolutePath();
+        loadSyncedVideos(filenames);
+    }
+}
+
+
+// Plays the given videos side by side, all in sync with the first one.
+void MainWindow::loadSyncedVideos(const QStringList &filenames)
+{
+    Q_D(MainWindow);
+    closeSyncedVideos();
+    d->playlistPlayer->abort();
+    d->ffmpegPlayback = false;
+    if (!d->streamGroup->open(filenames)) {
+        statusBar()->showMessage(tr("Cannot open '%1'.").arg(filenames.join("', '")), 5000);
+        return;
+    }
+    d->multiStream = true;
+    // the master stream stands in for the group in the status bar
+    QObject::connect(d->streamGroup->stream(0), SIGNAL(decodeFpsChanged(qreal)), SLOT(decodeFpsChanged(qreal)));
+    QObject::connect(d->streamGroup->stream(0), SIGNAL(throughputChanged(qreal, qreal, qreal)), SLOT(throughputChanged(qreal, qreal, qreal)));
+    // gaze is resampled onto the frames of the first video
+    d->currentVideoFilename = filenames.first();
+    updateFrameGaze();
+    if (d->compositeStreams) {
+        d->frameCompositor->setStreamCount(d->streamGroup->count());
+    }
+    else {
+        d->streamGroup->stream(0)->setConsumerResolution("render", d->renderWidget->targetSize());
+        for (int i = 1; i < d->streamGroup->count(); ++i) {
+            RenderWidget *widget = new RenderWidget;
+            widget->setWindowTitle(QFileInfo(filenames.at(i)).fileName());
+            widget->show();
+            d->streamWidgets.append(widget);
+        }
+    }
+    statusBar()->showMessage(tr("Decoding %1 streams with %2 threads each.").arg(d->streamGroup->count()).arg(d->streamGroup->threadsPerStream()), 5000);
+    d->playButton->setEnabled(true);
+    d->streamGroup->setPaused(!ui->actionAutoplayVideo->isChecked());
+    d->playButton->setIcon(style()->standardIcon(d->streamGroup->isPaused() ? QStyle::SP_MediaPlay : QStyle::SP_MediaPause));
+}
+
+
+void MainWindow::closeSyncedVideos(void)
+{
+    Q_D(MainWindow);
+    if (!d->multiStream)
+        return;
+    d->streamGroup->close();
+    d->frameCompositor->setStreamCount(0);
+    qDeleteAll(d->streamWidgets);
+    d->streamWidgets.clear();
+    d->multiStream = false;
+}
+
+
+void MainWindow::streamFrameReady(int stream, const VideoFrame &frame)
+{
+    Q_D(MainWindow);
+    if (d->compositeStreams)
+        d->frameCompositor->setFrame(stream, frame);
+    else if (stream == 0)
+        d->frameBroadcaster->publish(frame);
+    else if (stream <= d->streamWidgets.count())
+        d->streamWidgets.at(stream - 1)->setFrame(frame);
+}
+
+
+void MainWindow::positionChanged(qint64 position)
+{
+    Q_D(MainWindow);
+    // qDebug() << "MainWindow::positionChanged(" << position << ")";
+    if (!d->positionSlider->isSliderDown())
+        d->positionSlider->setValue((int)position);
+}
+
+
+void MainWindow::durationChanged(qint64 duration)
+{
+    Q_D(MainWindow);
+    qDebug() << "MainWindow::durationChanged(" << duration << ")";
+    d->positionSlider->setMaximum((int)duration);
+}
+
+
+void MainWindow::throughputChanged(qreal speed, qreal fps, qreal mediaRate)
+{
+    Q_D(MainWindow);
+    d->throughputLabel->setText(tr("%1x: %2 fps, %3x real time").arg(speed).arg(fps, 0, 'f', 1).arg(mediaRate, 0, 'f', 2));
+}
+
+
+void MainWindow::decodeFpsChanged(qreal fps)
+{
+    Q_D(MainWindow);
+    d->decodeFpsLabel->setText(tr("%1 fps decoded").arg(fps, 0, 'f', 1));
+}
+
+
+void MainWindow::presentationDeviationChanged(qreal meanAbsMs, qreal maxEarlyMs, qreal maxLateMs)
+{
+    Q_D(MainWindow);
+    d->presentationLabel->setText(tr("+/-%1 ms (early %2 ms, late %3 ms)")
+                                  .arg(meanAbsMs, 0, 'f', 1)
+                                  .arg(maxEarlyMs, 0, 'f', 1)
+                                  .arg(maxLateMs, 0, 'f', 1));
+}
+
+
+void MainWindow::seek(int position)
+{
+    Q_D(MainWindow);
+    if (d->multiStream)
+        d->streamGroup->seek(position);
+    else if (d->ffmpegPlayback)
+        d->decoderThread->seek(position);
+}
+
+
+// Every seek restarts the decoder, so while the slider is dragged only the
+// latest position is sought to, at most every SliderSeekIntervalMs.
+void MainWindow::sliderMoved(int position)
+{
+    Q_D(MainWindow);
+    d->sliderSeekPosition = position;
+    if (!d->sliderSeekTimer.isActive())
+        d->sliderSeekTimer.start();
+}
+
+
+void MainWindow::sliderReleased(void)
+{
+    Q_D(MainWindow);
+    d->sliderSeekTimer.stop();
+    seek(d->positionSlider->value());
+}
+
+
+void MainWindow::seekToSliderPosition(void)
+{
+    Q_D(MainWindow);
+    seek(d->sliderSeekPosition);
+}
+
+
+void MainWindow::seekCompleted(qint64 position, qint64 latencyMs)
+{
+    statusBar()->showMessage(tr("Seeked to %1 ms in %2 ms.").arg(position).arg(latencyMs), 3000);
+}
+
+
+void MainWindow::frameDropped(qint64 pts)
+{
+    Q_D(MainWindow);
+    d->droppedFrames.append(pts);
+}
+
+
+void MainWindow::preloadFinished(int frames, qint64 bytes, qint64 elapsedMs)
+{
+    statusBar()->showMessage(tr("Preloaded %1 frames (%2 MB) in %3 ms.").arg(frames).arg(bytes / 1024 / 1024).arg(elapsedMs), 3000);
+}
+
+
+void MainWindow::attachDecoder(DecoderThread *decoder)
+{
+    Q_D(MainWindow);
+    d->decoderThread = decoder;
+    QObject::connect(decoder, SIGNAL(durationChanged(qint64)), this, SLOT(durationChanged(qint64)));
+    QObject::connect(decoder, SIGNAL(decodeFpsChanged(qreal)), this, SLOT(decodeFpsChanged(qreal)));
+    QObject::connect(decoder, SIGNAL(seekCompleted(qint64, qint64)), this, SLOT(seekCompleted(qint64, qint64)));
+    QObject::connect(decoder, SIGNAL(frameDropped(qint64)), this, SLOT(frameDropped(qint64)));
+    QObject::connect(decoder, SIGNAL(preloadFinished(int, qint64, qint64)), this, SLOT(preloadFinished(int, qint64, qint64)));
+    QObject::connect(decoder, SIGNAL(throughputChanged(qreal, qreal, qreal)), this, SLOT(throughputChanged(qreal, qreal, qreal)));
+}
+
+
+void MainWindow::detachDecoder(DecoderThread *decoder)
+{
+    QObject::disconnect(decoder, nullptr, this, nullptr);
+}
+
+
+void MainWindow::currentClipChanged(int index, DecoderThread *previous, DecoderThread *current)
+{
+    Q_D(MainWindow);
+    if (previous != current) {
+        detachDecoder(previous);
+        attachDecoder(current);
+    }
+    durationChanged(current->duration());
+    if (d->playlistPlayer->playlist().count() > 1)
+        statusBar()->showMessage(tr("Playing clip %1 of %2.").arg(index + 1).arg(d->playlistPlayer->playlist().count()), 3000);
+}
+
+
+void MainWindow::clipSwitched(int index, qint64 gapUs)
+{
+    Q_UNUSED(index);
+    Q_D(MainWindow);
+    // the gap includes the display time of the previous clip's last frame, so a seamless switch takes one frame
+    const qint64 frameDurationUs = 1000 * d->playlistPlayer->current()->frameDuration();
+    if (frameDurationUs > 0 && gapUs > 2 * frameDurationUs)
+        qWarning() << "MainWindow: clip switch took" << gapUs << "us, a frame or more late";
+}
+
+
+void MainWindow::stepFrameForward(void)
+{
+    Q_D(MainWindow);
+    if (d->multiStream)
+        d->streamGroup->stepFrame(+1);
+    else if (d->ffmpegPlayback)
+        d->decoderThread->stepFrame(+1);
+}
+
+
+void MainWindow::stepFrameBackward(void)
+{
+    Q_D(MainWindow);
+    if (d->multiStream)
+        d->streamGroup->stepFrame(-1);
+    else if (d->ffmpegPlayback)
+        d->decoderThread->stepFrame(-1);
+}
+
+
+qreal MainWindow::playbackSpeed(void) const
+{
+    if (d_ptr->multiStream)
+        return d_ptr->streamGroup->speed();
+    if (d_ptr->ffmpegPlayback)
+        return d_ptr->decoderThread->speed();
+    return 1.0;
+}
+
+
+void MainWindow::setPlaybackSpeed(qreal speed)
+{
+    Q_D(MainWindow);
+    if (d->multiStream)
+        d->streamGroup->setSpeed(speed);
+    else if (d->ffmpegPlayback)
+        d->decoderThread->setSpeed(speed);
+    else
+        return;
+    statusBar()->showMessage(tr("Playback speed %1x").arg(playbackSpeed()), 3000);
+}
+
+
+void MainWindow::faster(void)
+{
+    const qreal speed = playbackSpeed();
+    setPlaybackSpeed(speed < 0 ? qMax(-8.0, 2 * speed) : qMin(8.0, 2 * speed));
+}
+
+
+void MainWindow::slower(void)
+{
+    const qreal speed = playbackSpeed();
+    setPlaybackSpeed(speed < 0 ? qMin(-0.125, 0.5 * speed) : qMax(0.125, 0.5 * speed));
+}
+
+
+void MainWindow::reverse(void)
+{
+    setPlaybackSpeed(-playbackSpeed());
+}
+
+
+void MainWindow::play(void)
+{
+    Q_D(MainWindow);
+    if (d->multiStream) {
+        d->streamGroup->setPaused(!d->streamGroup->isPaused());
+        d->playButton->setIcon(style()->standardIcon(d->streamGroup->isPaused() ? QStyle::SP_MediaPlay : QStyle::SP_MediaPause));
+        return;
+    }
+    if (d->ffmpegPlayback) {
+        d->playlistPlayer->setPaused(!d->playlistPlayer->isPaused());
+        d->playButton->setIcon(style()->standardIcon(d->playlistPlayer->isPaused() ? QStyle::SP_MediaPlay : QStyle::SP_MediaPause));
+    }
+}
+
@@ -1,66 +1,109 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#ifndef __MAINWINDOW_H_
-#define __MAINWINDOW_H_
-
-#include <QMainWindow>
-#include <QScopedPointer>
-#include <QPaintEvent>
-#include <QCloseEvent>
-#include <QImage>
-#include <QMediaPlayer>
-
-#include "eyexhost.h"
-
-namespace Ui {
-class MainWindow;
-}
-
-class MainWindowPrivate;
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-    explicit MainWindow(QWidget *parent = NULL);
-    ~MainWindow();
-
-protected:
-    void closeEvent(QCloseEvent *);
-
-private: // methods
-    void updateWindowTitle(void);
-    void saveSettings(void);
-    void restoreSettings(void);
-    void saveGazeData(void);
-    void saveGazeData(const QString &filename);
-    void loadGazeData(const QString &filename);
-    void loadVideo(const QString &filename);
-    void processFrame(void);
-
-private slots:
-    void setVirtualGazePoint(const QPointF &);
-    void addGazeSample(const Sample &);
-    void setFrame(const QImage &, int frameCount);
-    void renderWidgetReady(void);
-    void openVideo(void);
-    void openGazeData(void);
-    void mediaStateChanged(QMediaPlayer::State);
-    void handleError(void);
-    void play(void);
-    void positionChanged(qint64 position);
-    void durationChanged(qint64 duration);
-
-private:
-    Ui::MainWindow *ui;
-
-    QScopedPointer<MainWindowPrivate> d_ptr;
-    Q_DECLARE_PRIVATE(MainWindow)
-    Q_DISABLE_COPY(MainWindow)
-
-
-};
-
-#endif // __MAINWINDOW_H_
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __MAINWINDOW_H_
+#define __MAINWINDOW_H_
+
+#include <QMainWindow>
+#include <QScopedPointer>
+#include <QPaintEvent>
+#include <QCloseEvent>
+#include <QImage>
+#include <QStringList>
+
+#include "eyexhost.h"
+#include "videoframe.h"
+#include "sample.h"
+#include "gazelog.h"
+
+namespace Ui {
+class MainWindow;
+}
+
+class MainWindowPrivate;
+class DecoderThread;
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit MainWindow(QWidget *parent = NULL);
+    ~MainWindow();
+
+protected:
+    void closeEvent(QCloseEvent *);
+
+private: // methods
+    void updateWindowTitle(void);
+    void saveSettings(void);
+    void restoreSettings(void);
+    void saveGazeData(void);
+    void recordGazeSample(const Sample &);
+    void updateFrameGaze(void);
+    void saveDroppedFrames(const QString &filename);
+    void loadGazeData(const QString &filename, bool replay = true);
+    bool isReplayingGaze(void) const;
+    bool isPlaying(void) const;
+    qint64 playbackPosition(void) const;
+    qreal playbackSpeed(void) const;
+    void setPlaybackSpeed(qreal);
+    bool toVideoRelative(GazeColumns &, GazeLog::CoordinateSpace);
+    void loadVideo(const QString &filename);
+    void loadVideos(const QStringList &filenames);
+    void loadSyncedVideos(const QStringList &filenames);
+    void closeSyncedVideos(void);
+    void attachDecoder(DecoderThread *);
+    void detachDecoder(DecoderThread *);
+    void processFrame(void);
+
+private slots:
+    void applyDecoderSettings(DecoderThread *);
+    void setVirtualGazePoint(const QPointF &);
+    void addGazeSample(const Sample &);
+    void setFrame(const VideoFrame &);
+    void frameAvailable(const QString &subscriber);
+    void renderWidgetReady(void);
+    void renderTargetSizeChanged(const QSize &);
+    void videoTargetSizeChanged(const QSize &);
+    void openVideo(void);
+    void openSyncedVideos(void);
+    void streamFrameReady(int stream, const VideoFrame &);
+    void openGazeData(void);
+    void setGazeReplay(bool);
+    void unloadGazeData(void);
+    void mediaIndexed(void);
+    void exportGazeData(void);
+    void exportFrameGaze(void);
+    void play(void);
+    void positionChanged(qint64 position);
+    void durationChanged(qint64 duration);
+    void decodeFpsChanged(qreal fps);
+    void presentationDeviationChanged(qreal meanAbsMs, qreal maxEarlyMs, qreal maxLateMs);
+    void seek(int position);
+    void sliderMoved(int position);
+    void sliderReleased(void);
+    void seekToSliderPosition(void);
+    void seekCompleted(qint64 position, qint64 latencyMs);
+    void frameDropped(qint64 pts);
+    void preloadFinished(int frames, qint64 bytes, qint64 elapsedMs);
+    void currentClipChanged(int index, DecoderThread *previous, DecoderThread *current);
+    void clipSwitched(int index, qint64 gapUs);
+    void stepFrameForward(void);
+    void stepFrameBackward(void);
+    void faster(void);
+    void slower(void);
+    void reverse(void);
+    void throughputChanged(qreal speed, qreal fps, qreal mediaRate);
+
+private:
+    Ui::MainWindow *ui;
+
+    QScopedPointer<MainWindowPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(MainWindow)
+    Q_DISABLE_COPY(MainWindow)
+
+
+};
+
+#endif // __MAINWINDOW_H_
@@ -0,0 +1,247 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+#include "mediaindex.h"
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+#error "The media index format is little-endian and read without conversion."
+#endif
+
+namespace {
+
+const char Magic[4] = { 'D', 'V', 'M', 'I' };
+
+// On-disk layout, all fields little-endian:
+//   Header
+//   extradata, padded to a multiple of 8 bytes
+//   qint64 framePts[frameCount], sorted ascending
+//   KeyframeEntry keyframes[keyframeCount], sorted ascending by pts
+struct Header {
+    char magic[4];
+    quint32 version;
+    qint64 fileSize;
+    qint64 fileMTime;
+    qint64 durationMs;
+    qint64 startPts;
+    qint64 frameCount;
+    qint64 keyframeCount;
+    qint32 streamIndex;
+    qint32 codecId;
+    qint32 width;
+    qint32 height;
+    qint32 pixelFormat;
+    qint32 timeBaseNum;
+    qint32 timeBaseDen;
+    qint32 frameRateNum;
+    qint32 frameRateDen;
+    qint32 extradataSize;
+};
+
+inline qint64 padded(qint64 n)
+{
+    return (n + 7) & ~Q_INT64_C(7);
+}
+
+}
+
+
+class MediaIndexPrivate {
+public:
+    MediaIndexPrivate(void)
+        : map(nullptr)
+        , frameCount(0)
+        , framePts(nullptr)
+        , keyframeCount(0)
+        , keyframes(nullptr)
+    { /* ... */ }
+    QFile file;
+    uchar *map;
+    MediaIndex::StreamInfo streamInfo;
+    qint64 frameCount;
+    const qint64 *framePts;
+    qint64 keyframeCount;
+    const MediaIndex::KeyframeEntry *keyframes;
+};
+
+
+MediaIndex::MediaIndex(void)
+    : d_ptr(new MediaIndexPrivate)
+{
+    // ...
+}
+
+
+MediaIndex::~MediaIndex()
+{
+    unload();
+}
+
+
+QString MediaIndex::sidecarFilename(const QString &mediaFilename)
+{
+    return mediaFilename + ".dvidx";
+}
+
+
+bool MediaIndex::load(const QString &mediaFilename)
+{
+    Q_D(MediaIndex);
+    unload();
+    const QFileInfo mediaInfo(mediaFilename);
+    d->file.setFileName(sidecarFilename(mediaFilename));
+    if (!d->file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 mapSize = d->file.size();
+    if (mapSize < qint64(sizeof(Header))) {
+        unload();
+        return false;
+    }
+    d->map = d->file.map(0, mapSize);
+    if (d->map == nullptr) {
+        unload();
+        return false;
+    }
+    const Header *hdr = reinterpret_cast<const Header *>(d->map);
+    // the counts are bounded by the file size before any offset is computed from them, so that a corrupt header can't overflow it
+    bool valid = memcmp(hdr->magic, Magic, sizeof(Magic)) == 0
+            && hdr->version == Version
+            && hdr->fileSize == mediaInfo.size()
+            && hdr->fileMTime == mediaInfo.lastModified().toMSecsSinceEpoch()
+            && hdr->extradataSize >= 0
+            && hdr->extradataSize <= mapSize
+            && hdr->frameCount >= 0 && hdr->frameCount <= mapSize
+            && hdr->keyframeCount >= 0 && hdr->keyframeCount <= mapSize;
+    const qint64 ptsOffset = valid ? qint64(sizeof(Header)) + padded(hdr->extradataSize) : 0;
+    const qint64 keyframesOffset = valid ? ptsOffset + hdr->frameCount * qint64(sizeof(qint64)) : 0;
+    valid = valid && keyframesOffset + hdr->keyframeCount * qint64(sizeof(KeyframeEntry)) == mapSize;
+    if (!valid) {
+        qDebug() << "MediaIndex: ignoring stale or invalid" << d->file.fileName();
+        unload();
+        return false;
+    }
+    StreamInfo &si = d->streamInfo;
+    si.streamIndex = hdr->streamIndex;
+    si.codecId = hdr->codecId;
+    si.width = hdr->width;
+    si.height = hdr->height;
+    si.pixelFormat = hdr->pixelFormat;
+    si.timeBaseNum = hdr->timeBaseNum;
+    si.timeBaseDen = hdr->timeBaseDen;
+    si.frameRateNum = hdr->frameRateNum;
+    si.frameRateDen = hdr->frameRateDen;
+    si.durationMs = hdr->durationMs;
+    si.startPts = hdr->startPts;
+    si.extradata = QByteArray::fromRawData(reinterpret_cast<const char *>(d->map + sizeof(Header)), hdr->extradataSize);
+    d->frameCount = hdr->frameCount;
+    d->framePts = reinterpret_cast<const qint64 *>(d->map + ptsOffset);
+    d->keyframeCount = hdr->keyframeCount;
+    d->keyframes = reinterpret_cast<const KeyframeEntry *>(d->map + keyframesOffset);
+    return true;
+}
+
+
+bool MediaIndex::save(const QString &mediaFilename,
+                      const StreamInfo &si,
+                      const QVector<qint64> &framePts,
+                      const QVector<KeyframeIndex::Entry> &keyframes)
+{
+    const QFileInfo mediaInfo(mediaFilename);
+    Header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, Magic, sizeof(Magic));
+    hdr.version = Version;
+    hdr.fileSize = mediaInfo.size();
+    hdr.fileMTime = mediaInfo.lastModified().toMSecsSinceEpoch();
+    hdr.durationMs = si.durationMs;
+    hdr.startPts = si.startPts;
+    hdr.frameCount = framePts.count();
+    hdr.keyframeCount = keyframes.count();
+    hdr.streamIndex = si.streamIndex;
+    hdr.codecId = si.codecId;
+    hdr.width = si.width;
+    hdr.height = si.height;
+    hdr.pixelFormat = si.pixelFormat;
+    hdr.timeBaseNum = si.timeBaseNum;
+    hdr.timeBaseDen = si.timeBaseDen;
+    hdr.frameRateNum = si.frameRateNum;
+    hdr.frameRateDen = si.frameRateDen;
+    hdr.extradataSize = si.extradata.size();
+    // packets arrive in decoding order, but lookups need presentation order
+    QVector<qint64> sortedPts = framePts;
+    std::sort(sortedPts.begin(), sortedPts.end());
+    QVector<KeyframeEntry> kf(keyframes.count());
+    for (int i = 0; i < keyframes.count(); ++i) {
+        kf[i].pts = keyframes.at(i).pts;
+        kf[i].pos = keyframes.at(i).pos;
+    }
+    QSaveFile f(sidecarFilename(mediaFilename));
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    static const char zeros[8] = { 0 };
+    f.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    f.write(si.extradata);
+    f.write(zeros, padded(si.extradata.size()) - si.extradata.size());
+    f.write(reinterpret_cast<const char *>(sortedPts.constData()), sortedPts.count() * sizeof(qint64));
+    f.write(reinterpret_cast<const char *>(kf.constData()), kf.count() * sizeof(KeyframeEntry));
+    return f.commit();
+}
+
+
+void MediaIndex::unload(void)
+{
+    Q_D(MediaIndex);
+    if (d->map != nullptr) {
+        d->file.unmap(d->map);
+        d->map = nullptr;
+    }
+    d->file.close();
+    d->streamInfo = StreamInfo();
+    d->frameCount = 0;
+    d->framePts = nullptr;
+    d->keyframeCount = 0;
+    d->keyframes = nullptr;
+}
+
+
+bool MediaIndex::isLoaded(void) const
+{
+    return d_ptr->map != nullptr;
+}
+
+
+const MediaIndex::StreamInfo &MediaIndex::streamInfo(void) const
+{
+    return d_ptr->streamInfo;
+}
+
+
+qint64 MediaIndex::frameCount(void) const
+{
+    return d_ptr->frameCount;
+}
+
+
+const qint64 *MediaIndex::framePts(void) const
+{
+    return d_ptr->framePts;
+}
+
+
+qint64 MediaIndex::keyframeCount(void) const
+{
+    return d_ptr->keyframeCount;
+}
+
+
+const MediaIndex::KeyframeEntry *MediaIndex::keyframes(void) const
+{
+    return d_ptr->keyframes;
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __MEDIAINDEX_H_
+#define __MEDIAINDEX_H_
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QScopedPointer>
+
+#include "keyframeindex.h"
+
+
+class MediaIndexPrivate;
+
+// Sidecar file next to a video holding everything DecoderThread would
+// otherwise have to probe for: stream parameters, duration, the
+// presentation timestamps of all frames and the keyframe positions.
+// The sidecar is only accepted if size and modification time of the
+// video still match the values recorded in it.
+//
+// The file is memory-mapped on load; framePts() and keyframes() point
+// straight into the mapping. save() replaces the sidecar by renaming a
+// temporary file over it, which Windows refuses while the sidecar is
+// mapped, so a loaded index has to be unloaded before it is saved anew.
+class MediaIndex
+{
+public:
+    static const quint32 Version = 2;
+
+    class StreamInfo {
+    public:
+        StreamInfo(void)
+            : streamIndex(-1)
+            , codecId(0)
+            , width(0)
+            , height(0)
+            , pixelFormat(-1)
+            , timeBaseNum(0)
+            , timeBaseDen(1)
+            , frameRateNum(0)
+            , frameRateDen(1)
+            , durationMs(0)
+            , startPts(0)
+        { /* ... */ }
+        int streamIndex;
+        int codecId;
+        int width;
+        int height;
+        int pixelFormat;
+        int timeBaseNum;
+        int timeBaseDen;
+        int frameRateNum;
+        int frameRateDen;
+        qint64 durationMs;
+        // pts of the first frame in time base units, players show it at 0
+        qint64 startPts;
+        QByteArray extradata;
+    };
+
+    struct KeyframeEntry {
+        qint64 pts;
+        qint64 pos;
+    };
+
+    explicit MediaIndex(void);
+    ~MediaIndex();
+
+    static QString sidecarFilename(const QString &mediaFilename);
+
+    bool load(const QString &mediaFilename);
+    static bool save(const QString &mediaFilename,
+                     const StreamInfo &,
+                     const QVector<qint64> &framePts,
+                     const QVector<KeyframeIndex::Entry> &keyframes);
+    void unload(void);
+    bool isLoaded(void) const;
+
+    const StreamInfo &streamInfo(void) const;
+    qint64 frameCount(void) const;
+    const qint64 *framePts(void) const;
+    qint64 keyframeCount(void) const;
+    const KeyframeEntry *keyframes(void) const;
+
+private:
+    QScopedPointer<MediaIndexPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(MediaIndex)
+    Q_DISABLE_COPY(MediaIndex)
+
+};
+
+#endif // __MEDIAINDEX_H_
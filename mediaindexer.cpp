@@ -0,0 +1,135 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "mediaindexer.h"
+#include "mediaindex.h"
+#include "mediainput.h"
+#include "keyframeindex.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+
+class MediaIndexerPrivate {
+public:
+    MediaIndexerPrivate(void)
+        : doAbort(false)
+        , ok(false)
+    { /* ... */ }
+    QString filename;
+    volatile bool doAbort;
+    bool ok;
+};
+
+
+MediaIndexer::MediaIndexer(QObject *parent)
+    : QThread(parent)
+    , d_ptr(new MediaIndexerPrivate)
+{
+    av_register_all();
+}
+
+
+MediaIndexer::~MediaIndexer()
+{
+    abort();
+}
+
+
+// Starts indexing `filename`, aborting whatever is being indexed.
+void MediaIndexer::index(const QString &filename)
+{
+    Q_D(MediaIndexer);
+    abort();
+    d->filename = filename;
+    d->ok = false;
+    d->doAbort = false;
+    start(QThread::LowPriority);
+}
+
+
+void MediaIndexer::abort(void)
+{
+    Q_D(MediaIndexer);
+    d->doAbort = true;
+    wait();
+}
+
+
+QString MediaIndexer::filename(void) const
+{
+    return d_ptr->filename;
+}
+
+
+bool MediaIndexer::succeeded(void) const
+{
+    return d_ptr->ok;
+}
+
+
+void MediaIndexer::run(void)
+{
+    Q_D(MediaIndexer);
+    QElapsedTimer timer;
+    timer.start();
+    MediaInput input;
+    if (!input.open(d->filename))
+        return;
+    AVFormatContext *fmtCtx = avformat_alloc_context();
+    fmtCtx->pb = input.ioContext();
+    if (avformat_open_input(&fmtCtx, d->filename.toStdString().c_str(), nullptr, nullptr) < 0)
+        return;
+    const int streamIdx = avformat_find_stream_info(fmtCtx, nullptr) >= 0
+            ? av_find_best_stream(fmtCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0)
+            : -1;
+    if (streamIdx < 0) {
+        avformat_close_input(&fmtCtx);
+        return;
+    }
+    const AVStream *st = fmtCtx->streams[streamIdx];
+    const AVCodecContext *c = st->codec;
+    MediaIndex::StreamInfo si;
+    si.streamIndex = streamIdx;
+    si.codecId = c->codec_id;
+    si.width = c->width;
+    si.height = c->height;
+    si.pixelFormat = c->pix_fmt;
+    si.timeBaseNum = st->time_base.num;
+    si.timeBaseDen = st->time_base.den;
+    si.frameRateNum = st->avg_frame_rate.num;
+    si.frameRateDen = st->avg_frame_rate.den;
+    si.durationMs = fmtCtx->duration != AV_NOPTS_VALUE ? 1000 * fmtCtx->duration / AV_TIME_BASE : 0;
+    si.startPts = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+    if (c->extradata != nullptr)
+        si.extradata = QByteArray(reinterpret_cast<const char *>(c->extradata), c->extradata_size);
+    // the same timestamps DemuxerThread records while playing
+    QVector<qint64> framePts;
+    KeyframeIndex keyframes;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = nullptr;
+    pkt.size = 0;
+    while (!d->doAbort && av_read_frame(fmtCtx, &pkt) >= 0) {
+        if (pkt.stream_index == streamIdx) {
+            const int64_t ts = (pkt.pts != AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+            if (ts != AV_NOPTS_VALUE) {
+                if (pkt.flags & AV_PKT_FLAG_KEY)
+                    keyframes.add(ts, pkt.pos);
+                framePts.append(ts);
+            }
+        }
+        av_free_packet(&pkt);
+    }
+    avformat_close_input(&fmtCtx);
+    if (d->doAbort || framePts.isEmpty())
+        return;
+    d->ok = MediaIndex::save(d->filename, si, framePts, keyframes.entries());
+    qDebug() << "MediaIndexer:" << framePts.count() << "frames of" << d->filename << "indexed in" << timer.elapsed() << "ms";
+}
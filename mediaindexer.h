@@ -0,0 +1,43 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __MEDIAINDEXER_H_
+#define __MEDIAINDEXER_H_
+
+#include <QThread>
+#include <QString>
+#include <QScopedPointer>
+
+
+class MediaIndexerPrivate;
+
+// Writes the MediaIndex sidecar of a video without decoding it: the
+// container is demuxed once in the background and the timestamps and
+// keyframe positions of the video packets are collected. DecoderThread
+// records them as well, but only once it has played the video through,
+// and the gaze resampler needs them before that.
+// finished() is emitted when done; succeeded() tells whether the sidecar
+// was written.
+class MediaIndexer : public QThread
+{
+    Q_OBJECT
+public:
+    explicit MediaIndexer(QObject *parent = nullptr);
+    virtual ~MediaIndexer();
+
+    void index(const QString &filename);
+    void abort(void);
+    QString filename(void) const;
+    bool succeeded(void) const;
+
+protected:
+    virtual void run(void);
+
+private:
+    QScopedPointer<MediaIndexerPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(MediaIndexer)
+    Q_DISABLE_COPY(MediaIndexer)
+
+};
+
+#endif // __MEDIAINDEXER_H_
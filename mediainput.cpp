@@ -0,0 +1,354 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QFile>
+#include <QByteArray>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <cstring>
+
+#include "mediainput.h"
+
+extern "C" {
+#include <libavformat/avio.h>
+#include <libavutil/mem.h>
+#include <libavutil/error.h>
+}
+
+
+class MediaInputPrivate;
+
+class ReadAheadThread : public QThread {
+public:
+    explicit ReadAheadThread(MediaInputPrivate *d)
+        : d(d)
+    { /* ... */ }
+protected:
+    virtual void run(void);
+private:
+    MediaInputPrivate *d;
+};
+
+
+class MediaInputPrivate {
+public:
+    MediaInputPrivate(void)
+        : mode(MediaInput::Auto)
+        , window(MediaInput::DefaultReadAheadWindow)
+        , map(nullptr)
+        , size(0)
+        , pos(0)
+        , avio(nullptr)
+        , readAhead(nullptr)
+        , head(0)
+        , fill(0)
+        , eof(false)
+        , doAbort(false)
+        , generation(0)
+        , bytesRead(0)
+        , stalls(0)
+        , seeks(0)
+        , seekDistance(0)
+    { /* ... */ }
+    // the read-ahead thread reads at most this many bytes at a time
+    static const int ChunkSize = 256 * 1024;
+    QFile file;
+    MediaInput::Mode mode;
+    int window;
+    uchar *map;
+    qint64 size;
+    // offset of the next byte handed to libavformat
+    qint64 pos;
+    AVIOContext *avio;
+    ReadAheadThread *readAhead;
+    QMutex mtx;
+    QWaitCondition dataAvailable;
+    QWaitCondition spaceAvailable;
+    // ring buffer holding the `fill` bytes following `pos`, starting at `head`
+    QByteArray ring;
+    int head;
+    int fill;
+    bool eof;
+    bool doAbort;
+    // incremented on every seek outside the buffered window, so that a read
+    // which was in flight at that moment is discarded
+    int generation;
+    qint64 bytesRead;
+    int stalls;
+    int seeks;
+    qint64 seekDistance;
+
+    int read(uint8_t *buf, int bufSize)
+    {
+        QMutexLocker locker(&mtx);
+        if (map != nullptr) {
+            const int n = int(qMin(qint64(bufSize), size - pos));
+            if (n <= 0)
+                return AVERROR_EOF;
+            memcpy(buf, map + pos, size_t(n));
+            pos += n;
+            bytesRead += n;
+            return n;
+        }
+        if (fill == 0 && !eof && !doAbort) {
+            ++stalls;
+            while (fill == 0 && !eof && !doAbort)
+                dataAvailable.wait(&mtx);
+        }
+        if (fill == 0)
+            return AVERROR_EOF;
+        const int n = qMin(bufSize, fill);
+        const int first = qMin(n, ring.size() - head);
+        memcpy(buf, ring.constData() + head, size_t(first));
+        memcpy(buf + first, ring.constData(), size_t(n - first));
+        head = (head + n) % ring.size();
+        fill -= n;
+        pos += n;
+        bytesRead += n;
+        spaceAvailable.wakeOne();
+        return n;
+    }
+
+    qint64 seek(qint64 offset, int whence)
+    {
+        QMutexLocker locker(&mtx);
+        qint64 target;
+        switch (whence & ~AVSEEK_FORCE) {
+        case AVSEEK_SIZE:
+            return size;
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = pos + offset;
+            break;
+        case SEEK_END:
+            target = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+        }
+        if (target < 0 || target > size)
+            return AVERROR(EINVAL);
+        if (target == pos)
+            return target;
+        ++seeks;
+        seekDistance += qAbs(target - pos);
+        if (map == nullptr) {
+            if (target > pos && target <= pos + fill) {
+                const int skip = int(target - pos);
+                head = (head + skip) % ring.size();
+                fill -= skip;
+            }
+            else {
+                head = 0;
+                fill = 0;
+                eof = false;
+                ++generation;
+            }
+            spaceAvailable.wakeOne();
+        }
+        pos = target;
+        return target;
+    }
+
+    // Body of the read-ahead thread: tops up the ring buffer whenever there's room.
+    void fetch(void)
+    {
+        mtx.lock();
+        forever {
+            while (!doAbort && (fill == ring.size() || eof))
+                spaceAvailable.wait(&mtx);
+            if (doAbort)
+                break;
+            const int gen = generation;
+            const qint64 offset = pos + fill;
+            const int writeIdx = (head + fill) % ring.size();
+            const int n = qMin(qMin(ring.size() - fill, ring.size() - writeIdx), ChunkSize);
+            char *dst = ring.data() + writeIdx;
+            mtx.unlock();
+            // the consumer never touches the unfilled part of the ring, so reading into it needs no lock
+            qint64 got = -1;
+            if (file.pos() == offset || file.seek(offset))
+                got = file.read(dst, n);
+            mtx.lock();
+            if (gen != generation)
+                continue;
+            if (got <= 0)
+                eof = true;
+            else
+                fill += int(got);
+            dataAvailable.wakeAll();
+        }
+        mtx.unlock();
+    }
+
+    static int readPacket(void *opaque, uint8_t *buf, int bufSize)
+    {
+        return reinterpret_cast<MediaInputPrivate *>(opaque)->read(buf, bufSize);
+    }
+    static int64_t seekPacket(void *opaque, int64_t offset, int whence)
+    {
+        return reinterpret_cast<MediaInputPrivate *>(opaque)->seek(offset, whence);
+    }
+};
+
+
+void ReadAheadThread::run(void)
+{
+    d->fetch();
+}
+
+
+MediaInput::MediaInput(void)
+    : d_ptr(new MediaInputPrivate)
+{
+    // ...
+}
+
+
+MediaInput::~MediaInput()
+{
+    close();
+}
+
+
+// In Auto mode the file is mapped if possible and read ahead otherwise.
+bool MediaInput::open(const QString &filename, Mode mode)
+{
+    Q_D(MediaInput);
+    close();
+    d->file.setFileName(filename);
+    if (!d->file.open(QIODevice::ReadOnly))
+        return false;
+    d->size = d->file.size();
+    d->pos = 0;
+    d->bytesRead = 0;
+    d->stalls = 0;
+    d->seeks = 0;
+    d->seekDistance = 0;
+    if (mode != ReadAhead && d->size > 0)
+        d->map = d->file.map(0, d->size);
+    if (d->map != nullptr) {
+        d->mode = Mapped;
+    }
+    else {
+        // e.g. files too large for the address space of a 32-bit process
+        if (mode == Mapped)
+            qWarning() << "MediaInput: cannot map" << filename << "falling back to read-ahead";
+        d->mode = ReadAhead;
+        d->ring.resize(qMax(d->window, MediaInputPrivate::ChunkSize));
+        d->head = 0;
+        d->fill = 0;
+        d->eof = false;
+        d->doAbort = false;
+        d->readAhead = new ReadAheadThread(d);
+        d->readAhead->start();
+    }
+    uchar *buffer = reinterpret_cast<uchar *>(av_malloc(IOBufferSize));
+    d->avio = avio_alloc_context(buffer, IOBufferSize, 0, d, MediaInputPrivate::readPacket, nullptr, MediaInputPrivate::seekPacket);
+    if (d->avio == nullptr) {
+        av_free(buffer);
+        close();
+        return false;
+    }
+    qDebug() << "MediaInput:" << filename << (d->mode == Mapped ? "mapped" : "read ahead") << d->size << "bytes";
+    return true;
+}
+
+
+void MediaInput::close(void)
+{
+    Q_D(MediaInput);
+    if (d->avio != nullptr) {
+        // libavformat may have replaced the buffer passed to avio_alloc_context()
+        av_freep(&d->avio->buffer);
+        av_freep(&d->avio);
+    }
+    if (d->readAhead != nullptr) {
+        d->mtx.lock();
+        d->doAbort = true;
+        d->spaceAvailable.wakeAll();
+        d->dataAvailable.wakeAll();
+        d->mtx.unlock();
+        d->readAhead->wait();
+        delete d->readAhead;
+        d->readAhead = nullptr;
+        d->ring.clear();
+    }
+    if (d->map != nullptr) {
+        d->file.unmap(d->map);
+        d->map = nullptr;
+    }
+    if (d->file.isOpen())
+        d->file.close();
+}
+
+
+bool MediaInput::isOpen(void) const
+{
+    return d_ptr->avio != nullptr;
+}
+
+
+MediaInput::Mode MediaInput::mode(void) const
+{
+    return d_ptr->mode;
+}
+
+
+void MediaInput::setReadAheadWindow(int bytes)
+{
+    d_ptr->window = bytes;
+}
+
+
+int MediaInput::readAheadWindow(void) const
+{
+    return d_ptr->window;
+}
+
+
+AVIOContext *MediaInput::ioContext(void) const
+{
+    return d_ptr->avio;
+}
+
+
+qint64 MediaInput::size(void) const
+{
+    return d_ptr->size;
+}
+
+
+qint64 MediaInput::bytesRead(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->bytesRead;
+}
+
+
+// Number of reads that had to wait for the read-ahead thread. Always 0 for mapped files.
+int MediaInput::stalls(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->stalls;
+}
+
+
+int MediaInput::seeks(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->seeks;
+}
+
+
+// Sum of the distances in bytes covered by all seeks.
+qint64 MediaInput::seekDistance(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->seekDistance;
+}
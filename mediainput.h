@@ -0,0 +1,56 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __MEDIAINPUT_H_
+#define __MEDIAINPUT_H_
+
+#include <QString>
+#include <QScopedPointer>
+
+struct AVIOContext;
+
+class MediaInputPrivate;
+
+// Feeds a container file to libavformat through a custom AVIOContext.
+// Local files are memory-mapped so the demuxer never issues a read
+// syscall; if mapping is impossible or read-ahead is forced (e.g. for
+// network shares) a background thread keeps a window of the file
+// buffered ahead of the read position.
+class MediaInput
+{
+public:
+    enum Mode {
+        Auto,
+        Mapped,
+        ReadAhead
+    };
+    static const int DefaultReadAheadWindow = 8 * 1024 * 1024;
+    static const int IOBufferSize = 64 * 1024;
+
+    MediaInput(void);
+    ~MediaInput();
+
+    bool open(const QString &filename, Mode mode = Auto);
+    void close(void);
+    bool isOpen(void) const;
+    Mode mode(void) const;
+    // Takes effect with the next open().
+    void setReadAheadWindow(int bytes);
+    int readAheadWindow(void) const;
+    // Owned by MediaInput; assign it to AVFormatContext::pb before opening the input.
+    AVIOContext *ioContext(void) const;
+    qint64 size(void) const;
+
+    qint64 bytesRead(void) const;
+    int stalls(void) const;
+    int seeks(void) const;
+    qint64 seekDistance(void) const;
+
+private:
+    QScopedPointer<MediaInputPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(MediaInput)
+    Q_DISABLE_COPY(MediaInput)
+
+};
+
+#endif // __MEDIAINPUT_H_
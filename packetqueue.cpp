@@ -0,0 +1,219 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+
+#include "packetqueue.h"
+
+
+class PacketQueuePrivate {
+public:
+    PacketQueuePrivate(void)
+        : bytes(0)
+        , durationMs(0)
+        , maxBytes(PacketQueue::DefaultMaxBytes)
+        , maxDurationMs(PacketQueue::DefaultMaxDurationMs)
+        , lowWatermark(0.5)
+        , defaultPacketDuration(0)
+        , eof(false)
+        , cancelled(false)
+        , underruns(0)
+        , highWaterHits(0)
+    {
+        timeBase.num = 1;
+        timeBase.den = 1000;
+    }
+    ~PacketQueuePrivate()
+    {
+        clear();
+    }
+    void clear(void)
+    {
+        while (!packets.isEmpty()) {
+            AVPacket pkt = packets.dequeue();
+            av_free_packet(&pkt);
+        }
+        bytes = 0;
+        durationMs = 0;
+    }
+    qint64 packetDurationMs(const AVPacket *pkt) const
+    {
+        static const AVRational ms = {1, 1000};
+        return av_rescale_q(pkt->duration > 0 ? pkt->duration : defaultPacketDuration, timeBase, ms);
+    }
+    bool aboveHighWatermark(void) const
+    {
+        return bytes >= maxBytes || durationMs >= maxDurationMs;
+    }
+    bool belowLowWatermark(void) const
+    {
+        return bytes < lowWatermark * maxBytes && durationMs < lowWatermark * maxDurationMs;
+    }
+    QMutex mtx;
+    QWaitCondition notEmpty;
+    QWaitCondition belowLow;
+    QQueue<AVPacket> packets;
+    int bytes;
+    qint64 durationMs;
+    int maxBytes;
+    qint64 maxDurationMs;
+    qreal lowWatermark;
+    AVRational timeBase;
+    int64_t defaultPacketDuration;
+    bool eof;
+    bool cancelled;
+    int underruns;
+    int highWaterHits;
+};
+
+
+PacketQueue::PacketQueue(void)
+    : d_ptr(new PacketQueuePrivate)
+{
+    // ...
+}
+
+
+PacketQueue::~PacketQueue()
+{
+    // ...
+}
+
+
+void PacketQueue::setLimits(int maxBytes, int maxDurationMs, qreal lowWatermark)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    d->maxBytes = maxBytes;
+    d->maxDurationMs = maxDurationMs;
+    d->lowWatermark = qBound(0.0, lowWatermark, 1.0);
+    d->belowLow.wakeAll();
+}
+
+
+// `defaultPacketDuration` (in units of `timeBase`) is used for packets that don't carry a duration.
+void PacketQueue::setTimeBase(AVRational timeBase, int64_t defaultPacketDuration)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    d->timeBase = timeBase;
+    d->defaultPacketDuration = defaultPacketDuration;
+}
+
+
+// Takes ownership of the packet's data. Blocks once the high watermark is
+// reached until the consumer has drained the queue below the low watermark.
+// Returns false if the queue has been cancelled.
+bool PacketQueue::push(AVPacket *pkt)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    if (d->aboveHighWatermark() && !d->cancelled) {
+        ++d->highWaterHits;
+        while (!d->belowLowWatermark() && !d->cancelled)
+            d->belowLow.wait(&d->mtx);
+    }
+    if (d->cancelled || av_dup_packet(pkt) < 0) {
+        av_free_packet(pkt);
+        return false;
+    }
+    d->packets.enqueue(*pkt);
+    d->bytes += pkt->size;
+    d->durationMs += d->packetDurationMs(pkt);
+    d->notEmpty.wakeOne();
+    return true;
+}
+
+
+// Blocks until a packet is available. Returns false if there are no more
+// packets to come, either because of end of file or because the queue has
+// been cancelled. The caller has to free the packet.
+bool PacketQueue::pop(AVPacket *pkt)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    if (d->packets.isEmpty() && !d->eof && !d->cancelled) {
+        ++d->underruns;
+        while (d->packets.isEmpty() && !d->eof && !d->cancelled)
+            d->notEmpty.wait(&d->mtx);
+    }
+    if (d->cancelled || d->packets.isEmpty())
+        return false;
+    *pkt = d->packets.dequeue();
+    d->bytes -= pkt->size;
+    d->durationMs -= d->packetDurationMs(pkt);
+    if (d->belowLowWatermark())
+        d->belowLow.wakeOne();
+    return true;
+}
+
+
+void PacketQueue::setEof(void)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    d->eof = true;
+    d->notEmpty.wakeAll();
+}
+
+
+void PacketQueue::cancel(void)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    d->cancelled = true;
+    d->notEmpty.wakeAll();
+    d->belowLow.wakeAll();
+}
+
+
+// Drops all packets and makes the queue ready for a new run.
+void PacketQueue::reset(void)
+{
+    Q_D(PacketQueue);
+    QMutexLocker locker(&d->mtx);
+    d->clear();
+    d->eof = false;
+    d->cancelled = false;
+    d->underruns = 0;
+    d->highWaterHits = 0;
+}
+
+
+int PacketQueue::count(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->packets.count();
+}
+
+
+int PacketQueue::bytes(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->bytes;
+}
+
+
+qint64 PacketQueue::durationMs(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->durationMs;
+}
+
+
+int PacketQueue::underruns(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->underruns;
+}
+
+
+int PacketQueue::highWaterHits(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->highWaterHits;
+}
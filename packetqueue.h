@@ -0,0 +1,52 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __PACKETQUEUE_H_
+#define __PACKETQUEUE_H_
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+
+class PacketQueuePrivate;
+
+// Bounded queue of compressed packets between demuxer and decoder.
+// The queue is limited both by the number of bytes and by the play time
+// it holds. Once either limit (the high watermark) is hit the producer
+// is held back until the queue has drained below the low watermark.
+class PacketQueue
+{
+public:
+    static const int DefaultMaxBytes = 16 * 1024 * 1024;
+    static const int DefaultMaxDurationMs = 2000;
+
+    explicit PacketQueue(void);
+    ~PacketQueue();
+
+    void setLimits(int maxBytes, int maxDurationMs, qreal lowWatermark = 0.5);
+    void setTimeBase(AVRational timeBase, int64_t defaultPacketDuration);
+
+    bool push(AVPacket *);
+    bool pop(AVPacket *);
+    void setEof(void);
+    void cancel(void);
+    void reset(void);
+
+    int count(void) const;
+    int bytes(void) const;
+    qint64 durationMs(void) const;
+    int underruns(void) const;
+    int highWaterHits(void) const;
+
+private:
+    QScopedPointer<PacketQueuePrivate> d_ptr;
+    Q_DECLARE_PRIVATE(PacketQueue)
+    Q_DISABLE_COPY(PacketQueue)
+
+};
+
+#endif // __PACKETQUEUE_H_
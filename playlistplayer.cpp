@@ -0,0 +1,322 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "playlistplayer.h"
+
+
+// Opens a clip on the standby decoder and lets it decode the first GOP
+// while paused, so that it only has to be unpaused at the clip boundary.
+// The standby decoder is handed over to this thread for that time: the
+// player doesn't touch it until wait() has returned, and decoders()
+// waits as well before it gives the decoders out.
+class PrepareThread : public QThread {
+public:
+    PrepareThread(void)
+        : decoder(nullptr)
+        , index(-1)
+        , ok(false)
+        , elapsedMs(0)
+    { /* ... */ }
+    DecoderThread *decoder;
+    QString filename;
+    int index;
+    bool ok;
+    qint64 elapsedMs;
+protected:
+    virtual void run(void)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        decoder->abort();
+        ok = decoder->openVideo(filename);
+        if (ok) {
+            const int gop = decoder->gopLength();
+            if (gop > decoder->prefetchFrames())
+                decoder->setPrefetchFrames(qMin(gop, int(PlaylistPlayer::MaxPreparedFrames)));
+            decoder->setPaused(true);
+            decoder->start();
+        }
+        elapsedMs = timer.elapsed();
+    }
+};
+
+
+class PlaylistPlayerPrivate {
+public:
+    PlaylistPlayerPrivate(void)
+        : index(-1)
+        , active(0)
+        , scheduler(nullptr)
+        , preparedIndex(-1)
+        , lastPts(-1)
+        , switching(false)
+        , atEnd(false)
+    {
+        decoder[0] = new DecoderThread;
+        decoder[1] = new DecoderThread;
+        savedPrefetchFrames[0] = -1;
+        savedPrefetchFrames[1] = -1;
+        scheduler = new FrameScheduler(decoder[0]->frameQueue(), decoder[0]->presentationClock());
+    }
+    ~PlaylistPlayerPrivate()
+    {
+        delete scheduler;
+        delete decoder[0];
+        delete decoder[1];
+    }
+    QStringList playlist;
+    int index;
+    DecoderThread *decoder[2];
+    int active;
+    // prefetch setting of a decoder while it's raised for preparing a clip, -1 otherwise
+    int savedPrefetchFrames[2];
+    FrameScheduler *scheduler;
+    PrepareThread prepareThread;
+    // index of the clip ready in the standby decoder, -1 if none
+    int preparedIndex;
+    qint64 lastPts;
+    QElapsedTimer presentTimer;
+    bool switching;
+    bool atEnd;
+    // fires when the last frame of the current clip has been on screen for its full duration
+    QTimer switchTimer;
+
+    DecoderThread *current(void) const { return decoder[active]; }
+    DecoderThread *standby(void) const { return decoder[1 - active]; }
+};
+
+
+PlaylistPlayer::PlaylistPlayer(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new PlaylistPlayerPrivate)
+{
+    Q_D(PlaylistPlayer);
+    d->switchTimer.setSingleShot(true);
+    d->switchTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&d->switchTimer, SIGNAL(timeout()), SLOT(switchToNext()));
+    QObject::connect(&d->prepareThread, SIGNAL(finished()), SLOT(prepared()));
+    QObject::connect(d->scheduler, SIGNAL(framePresented(qint64, qint64)), SLOT(framePresented(qint64)));
+    for (int i = 0; i < 2; ++i) {
+        // the scheduler only ever looks at the active decoder's queue, so the standby decoder waking it is harmless
+        QObject::connect(d->decoder[i], SIGNAL(frameAvailable()), d->scheduler, SLOT(schedule()));
+        QObject::connect(d->decoder[i], SIGNAL(finished()), SLOT(checkBoundary()));
+    }
+}
+
+
+PlaylistPlayer::~PlaylistPlayer()
+{
+    abort();
+}
+
+
+// Takes effect with the next play().
+void PlaylistPlayer::setPlaylist(const QStringList &filenames)
+{
+    Q_D(PlaylistPlayer);
+    d->playlist = filenames;
+}
+
+
+QStringList PlaylistPlayer::playlist(void) const
+{
+    return d_ptr->playlist;
+}
+
+
+int PlaylistPlayer::currentIndex(void) const
+{
+    return d_ptr->index;
+}
+
+
+DecoderThread *PlaylistPlayer::current(void) const
+{
+    return d_ptr->current();
+}
+
+
+// Both decoders, e.g. to apply the same settings to them. Waits until the
+// standby decoder has been handed back by the preparing thread.
+QList<DecoderThread *> PlaylistPlayer::decoders(void) const
+{
+    d_ptr->prepareThread.wait();
+    return QList<DecoderThread *>() << d_ptr->decoder[0] << d_ptr->decoder[1];
+}
+
+
+FrameScheduler *PlaylistPlayer::scheduler(void) const
+{
+    return d_ptr->scheduler;
+}
+
+
+bool PlaylistPlayer::isPaused(void) const
+{
+    return d_ptr->current()->isPaused();
+}
+
+
+void PlaylistPlayer::abort(void)
+{
+    Q_D(PlaylistPlayer);
+    d->switchTimer.stop();
+    d->prepareThread.wait();
+    d->prepareThread.index = -1;
+    d->preparedIndex = -1;
+    d->decoder[0]->abort();
+    d->decoder[1]->abort();
+    restorePrefetchFrames(0);
+    restorePrefetchFrames(1);
+}
+
+
+// Starts the clip at `index` right away, which means opening it in the
+// foreground, and prepares the one after it.
+bool PlaylistPlayer::play(int index, bool paused)
+{
+    Q_D(PlaylistPlayer);
+    if (index < 0 || index >= d->playlist.count())
+        return false;
+    abort();
+    DecoderThread *decoder = d->current();
+    if (!decoder->openVideo(d->playlist.at(index))) {
+        qWarning() << "PlaylistPlayer: cannot open" << d->playlist.at(index);
+        return false;
+    }
+    d->index = index;
+    d->lastPts = -1;
+    d->switching = false;
+    d->atEnd = false;
+    d->scheduler->setSource(decoder->frameQueue(), decoder->presentationClock());
+    decoder->setPaused(paused);
+    decoder->start();
+    emit currentChanged(index, decoder, decoder);
+    prepare(index + 1);
+    return true;
+}
+
+
+void PlaylistPlayer::setPaused(bool paused)
+{
+    Q_D(PlaylistPlayer);
+    d->current()->setPaused(paused);
+    if (paused)
+        d->switchTimer.stop();
+    else
+        checkBoundary();
+}
+
+
+void PlaylistPlayer::prepare(int index)
+{
+    Q_D(PlaylistPlayer);
+    if (index >= d->playlist.count())
+        return;
+    d->prepareThread.wait();
+    const int standby = 1 - d->active;
+    if (d->savedPrefetchFrames[standby] < 0)
+        d->savedPrefetchFrames[standby] = d->decoder[standby]->prefetchFrames();
+    d->prepareThread.decoder = d->decoder[standby];
+    d->prepareThread.filename = d->playlist.at(index);
+    d->prepareThread.index = index;
+    d->prepareThread.start();
+}
+
+
+void PlaylistPlayer::restorePrefetchFrames(int decoder)
+{
+    Q_D(PlaylistPlayer);
+    if (d->savedPrefetchFrames[decoder] < 0)
+        return;
+    d->decoder[decoder]->setPrefetchFrames(d->savedPrefetchFrames[decoder]);
+    d->savedPrefetchFrames[decoder] = -1;
+}
+
+
+void PlaylistPlayer::prepared(void)
+{
+    Q_D(PlaylistPlayer);
+    // a stale notification from a run cut short by abort()
+    if (d->prepareThread.isRunning())
+        return;
+    const PrepareThread &p = d->prepareThread;
+    if (p.index < 0 || p.decoder != d->standby())
+        return;
+    if (!p.ok) {
+        qWarning() << "PlaylistPlayer: cannot open" << p.filename << "- skipping it";
+        prepare(p.index + 1);
+        return;
+    }
+    qDebug() << "PlaylistPlayer: prepared" << p.filename << "in" << p.elapsedMs << "ms";
+    d->preparedIndex = p.index;
+    emit nextPrepared(p.index, p.elapsedMs);
+    checkBoundary();
+}
+
+
+void PlaylistPlayer::framePresented(qint64 pts)
+{
+    Q_D(PlaylistPlayer);
+    if (d->switching) {
+        d->switching = false;
+        const qint64 gapUs = d->presentTimer.nsecsElapsed() / 1000;
+        qDebug() << "PlaylistPlayer: switched to clip" << d->index << "after" << gapUs << "us";
+        emit clipSwitched(d->index, gapUs);
+    }
+    d->presentTimer.start();
+    d->lastPts = pts;
+    checkBoundary();
+}
+
+
+// Arms the switch timer once the current decoder has delivered its last
+// frame and the scheduler has put it on screen.
+void PlaylistPlayer::checkBoundary(void)
+{
+    Q_D(PlaylistPlayer);
+    DecoderThread *decoder = d->current();
+    if (d->index < 0 || d->switchTimer.isActive() || !decoder->isFinished() || decoder->isPaused() || decoder->frameQueue()->count() > 0)
+        return;
+    if (d->preparedIndex < 0) {
+        if (d->index + 1 >= d->playlist.count() && !d->prepareThread.isRunning() && !d->atEnd) {
+            d->atEnd = true;
+            emit playlistFinished();
+        }
+        // otherwise switch as soon as the next clip is ready
+        return;
+    }
+    const qint64 dueUs = d->lastPts < 0
+            ? 0
+            : decoder->presentationClock()->usecsUntil(d->lastPts + decoder->frameDuration());
+    d->switchTimer.start(int(qMax(Q_INT64_C(0), dueUs) / 1000));
+}
+
+
+void PlaylistPlayer::switchToNext(void)
+{
+    Q_D(PlaylistPlayer);
+    if (d->preparedIndex < 0)
+        return;
+    DecoderThread *previous = d->current();
+    d->active = 1 - d->active;
+    DecoderThread *decoder = d->current();
+    restorePrefetchFrames(d->active);
+    d->index = d->preparedIndex;
+    d->preparedIndex = -1;
+    d->lastPts = -1;
+    d->switching = true;
+    d->scheduler->setSource(decoder->frameQueue(), decoder->presentationClock());
+    decoder->setSpeed(previous->speed());
+    decoder->setPaused(false);
+    // the first frame is already waiting in the queue
+    d->scheduler->schedule();
+    emit currentChanged(d->index, previous, decoder);
+    // the previous decoder is stopped and reused in the background
+    prepare(d->index + 1);
+}
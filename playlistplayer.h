@@ -0,0 +1,70 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __PLAYLISTPLAYER_H_
+#define __PLAYLISTPLAYER_H_
+
+#include <QObject>
+#include <QStringList>
+#include <QList>
+#include <QScopedPointer>
+
+#include "decoderthread.h"
+#include "framescheduler.h"
+
+
+class PlaylistPlayerPrivate;
+
+// Plays a list of clips back to back without a gap. Two decoders take
+// turns: while one plays the current clip, the other opens and probes
+// the next one in the background and decodes its first GOP. At the end
+// of the current clip the frame scheduler is switched over to the
+// standby decoder when the last frame's display time is up.
+class PlaylistPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    // upper limit for the number of frames decoded ahead for the next clip
+    static const int MaxPreparedFrames = 64;
+
+    explicit PlaylistPlayer(QObject *parent = nullptr);
+    ~PlaylistPlayer();
+
+    void setPlaylist(const QStringList &filenames);
+    QStringList playlist(void) const;
+    int currentIndex(void) const;
+    DecoderThread *current(void) const;
+    QList<DecoderThread *> decoders(void) const;
+    FrameScheduler *scheduler(void) const;
+    bool isPaused(void) const;
+    void abort(void);
+
+signals:
+    void currentChanged(int index, DecoderThread *previous, DecoderThread *current);
+    void nextPrepared(int index, qint64 elapsedMs);
+    // `gapUs` is the time between the last frame of the previous clip and the first of the new one
+    void clipSwitched(int index, qint64 gapUs);
+    void playlistFinished(void);
+
+public slots:
+    bool play(int index, bool paused = false);
+    void setPaused(bool);
+
+private slots:
+    void prepared(void);
+    void framePresented(qint64 pts);
+    void checkBoundary(void);
+    void switchToNext(void);
+
+private: // methods
+    void prepare(int index);
+    void restorePrefetchFrames(int decoder);
+
+private:
+    QScopedPointer<PlaylistPlayerPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(PlaylistPlayer)
+    Q_DISABLE_COPY(PlaylistPlayer)
+
+};
+
+#endif // __PLAYLISTPLAYER_H_
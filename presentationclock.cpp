@@ -0,0 +1,134 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "presentationclock.h"
+
+
+class PresentationClockPrivate {
+public:
+    PresentationClockPrivate(void)
+        : baseNs(0)
+        , baseUs(0)
+        , speed(1.0)
+        , paused(false)
+        , valid(false)
+    {
+        timer.start();
+    }
+    // media time in microseconds
+    qint64 mediaUs(qint64 nowNs) const
+    {
+        if (paused)
+            return baseUs;
+        return baseUs + qint64(speed * (nowNs - baseNs) / 1000);
+    }
+    void rebase(void)
+    {
+        const qint64 nowNs = timer.nsecsElapsed();
+        baseUs = mediaUs(nowNs);
+        baseNs = nowNs;
+    }
+    mutable QMutex mtx;
+    QElapsedTimer timer;
+    qint64 baseNs;
+    qint64 baseUs;
+    qreal speed;
+    bool paused;
+    bool valid;
+};
+
+
+PresentationClock::PresentationClock(void)
+    : d_ptr(new PresentationClockPrivate)
+{
+    // ...
+}
+
+
+PresentationClock::~PresentationClock()
+{
+    // ...
+}
+
+
+// Makes `ms` the current media time.
+void PresentationClock::sync(qint64 ms)
+{
+    Q_D(PresentationClock);
+    QMutexLocker locker(&d->mtx);
+    d->baseNs = d->timer.nsecsElapsed();
+    d->baseUs = 1000 * ms;
+    d->valid = true;
+}
+
+
+// The clock stays invalid until the next call to sync(), e.g. after a seek.
+void PresentationClock::invalidate(void)
+{
+    Q_D(PresentationClock);
+    QMutexLocker locker(&d->mtx);
+    d->valid = false;
+}
+
+
+bool PresentationClock::isValid(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->valid;
+}
+
+
+void PresentationClock::setPaused(bool paused)
+{
+    Q_D(PresentationClock);
+    QMutexLocker locker(&d->mtx);
+    d->rebase();
+    d->paused = paused;
+}
+
+
+bool PresentationClock::isPaused(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->paused;
+}
+
+
+// A negative speed makes media time run backwards.
+void PresentationClock::setSpeed(qreal speed)
+{
+    Q_D(PresentationClock);
+    Q_ASSERT(!qFuzzyIsNull(speed));
+    QMutexLocker locker(&d->mtx);
+    d->rebase();
+    d->speed = speed;
+}
+
+
+qreal PresentationClock::speed(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->speed;
+}
+
+
+// Current media time in milliseconds.
+qint64 PresentationClock::time(void) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    return d_ptr->mediaUs(d_ptr->timer.nsecsElapsed()) / 1000;
+}
+
+
+// Wall clock time in microseconds until media time `ms` is reached,
+// negative if it has passed already.
+qint64 PresentationClock::usecsUntil(qint64 ms) const
+{
+    QMutexLocker locker(&d_ptr->mtx);
+    const qint64 deltaUs = 1000 * ms - d_ptr->mediaUs(d_ptr->timer.nsecsElapsed());
+    return qint64(deltaUs / d_ptr->speed);
+}
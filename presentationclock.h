@@ -0,0 +1,40 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __PRESENTATIONCLOCK_H_
+#define __PRESENTATIONCLOCK_H_
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+
+class PresentationClockPrivate;
+
+// Maps a monotonic wall clock onto media time. The clock is anchored to a
+// frame's presentation timestamp with sync() and advances `speed` times as
+// fast as real time from then on. May be accessed from any thread.
+class PresentationClock
+{
+public:
+    explicit PresentationClock(void);
+    ~PresentationClock();
+
+    void sync(qint64 ms);
+    void invalidate(void);
+    bool isValid(void) const;
+    void setPaused(bool paused);
+    bool isPaused(void) const;
+    void setSpeed(qreal speed);
+    qreal speed(void) const;
+
+    qint64 time(void) const;
+    qint64 usecsUntil(qint64 ms) const;
+
+private:
+    QScopedPointer<PresentationClockPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(PresentationClock)
+    Q_DISABLE_COPY(PresentationClock)
+
+};
+
+#endif // __PRESENTATIONCLOCK_H_
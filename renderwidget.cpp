@@ -1,246 +1,390 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#include "sample.h"
-#include "renderwidget.h"
-#include "util.h"
-#include "main.h"
-#include "kernel.h"
-#include "decoderthread.h"
-
-#include <QtCore/QDebug>
-#include <QtOpenGL>
-#include <QGLFramebufferObject>
-#include <QFile>
-#include <QTextStream>
-#include <QMap>
-
-class RenderWidgetPrivate {
-public:
-    explicit RenderWidgetPrivate(void)
-        : firstPaintEvent(true)
-        , fbo(nullptr)
-        , textureHandle(0)
-        , glVersionMajor(0)
-        , glVersionMinor(0)
-        , gazePoint(0.5, 0.5)
-        , peepholeRadius(0.2f) // 0.0 .. 1.0
-    { /* ... */ }
-    QSize frameSize;
-    QColor backgroundColor;
-    bool firstPaintEvent;
-    KernelList kernels;
-    QGLFramebufferObject* fbo;
-    GLuint textureHandle;
-    QSizeF resolution;
-    QRect viewport;
-    GLint glVersionMajor;
-    GLint glVersionMinor;
-    QPointF gazePoint;
-    GLfloat peepholeRadius;
-    Samples gazeSamples;
-
-    virtual ~RenderWidgetPrivate()
-    {
-        safeDelete(fbo);
-    }
-};
-
-
-RenderWidget::RenderWidget(QWidget *parent)
-    : QGLWidget(QGLFormat(QGL::SingleBuffer | QGL::NoDepthBuffer
-                          | QGL::AlphaChannel | QGL::NoAccumBuffer
-                          | QGL::NoStencilBuffer | QGL::NoStereoBuffers
-                          | QGL::HasOverlay |QGL::NoSampleBuffers), parent)
-    , d_ptr(new RenderWidgetPrivate)
-{
-    setWindowTitle(QString("%1 - Live Preview").arg(AppName));
-}
-
-
-RenderWidget::~RenderWidget()
-{
-    // ...
-}
-
-
-void RenderWidget::makeFBO(void)
-{
-    Q_D(RenderWidget);
-    makeCurrent();
-    if (d->fbo == nullptr || d->fbo->size() != d->frameSize)
-        safeRenew(d->fbo, new QGLFramebufferObject(d->frameSize));
-}
-
-
-void RenderWidget::resizeGL(int w, int h)
-{
-    updateViewport(w, h);
-}
-
-
-void RenderWidget::initializeGL(void)
-{
-    Q_D(RenderWidget);
-    initializeGLFunctions();
-    glGetIntegerv(GL_MAJOR_VERSION, &d->glVersionMajor);
-    glGetIntegerv(GL_MINOR_VERSION, &d->glVersionMinor);
-    qglClearColor(d->backgroundColor);
-    glEnable(GL_TEXTURE_2D);
-    glDepthMask(GL_FALSE);
-
-    // make texture
-    glGenTextures(1, &d->textureHandle);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, d->textureHandle);
-
-    // configure texture
-    makeCurrent();
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-
-    // load kernels
-    auto addKernel = [&d](const QString &name) {
-        Kernel *kernel;
-        kernel = new Kernel;
-        kernel->setShaders(":/shaders/default.vert",
-                           QString(":/shaders/%1.frag").arg(name));
-        qDebug() << "PROGRAM LINKED:" << kernel->isFunctional();
-        if (kernel->isFunctional())
-            d->kernels.append(kernel);
-        else
-            delete kernel;
-    };
-
-#if FILTER_FADE_TO_BLACK
-    addKernel("fade2black");
-#elif FILTER_BLUR
-    addKernel("hblur");
-    addKernel("vblur");
-#endif
-}
-
-
-void RenderWidget::paintGL(void)
-{
-    Q_D(RenderWidget);
-    if (d->firstPaintEvent) {
-        d->firstPaintEvent = false;
-        emit ready();
-    }
-
-    glClear(GL_COLOR_BUFFER_BIT);
-    glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
-
-    if (d->fbo == nullptr)
-        return;
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, d->textureHandle);
-    d->fbo->bind();
-    foreach (Kernel *k, d->kernels) {
-        if (k->isFunctional()) {
-            k->program->setUniformValue(k->uLocGazePoint, d->gazePoint);
-            k->program->setUniformValue(k->uLocPeepholeRadius, d->peepholeRadius);
-            k->program->setUniformValue(k->uLocResolution, d->resolution);
-            k->program->setAttributeArray(Kernel::ATEXCOORD, Kernel::TexCoords4FBO);
-            k->program->bind();
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            glBindTexture(GL_TEXTURE_2D, d->fbo->texture());
-        }
-        k->program->setAttributeArray(Kernel::ATEXCOORD, Kernel::TexCoords);
-    }
-    d->fbo->release();
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-}
-
-
-void RenderWidget::closeEvent(QCloseEvent *e)
-{
-    e->accept();
-}
-
-
-void RenderWidget::setFrame(const QImage &image, int nr)
-{
-    Q_D(RenderWidget);
-    Q_UNUSED(nr);
-    QImage img;
-    if (!image.isNull()) {
-        img = image.convertToFormat(QImage::Format_ARGB32);
-        d->frameSize = image.size();
-        makeFBO();
-    }
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, d->textureHandle);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width(), img.height(), 0, GL_BGRA, GL_UNSIGNED_BYTE, img.bits());
-    gFramesProduced.release();
-    updateViewport();
-}
-
-
-void RenderWidget::setGazePoint(const QPointF &gazePoint)
-{
-    Q_D(RenderWidget);
-    d->gazePoint = gazePoint;
-    updateGL();
-}
-
-
-void RenderWidget::setPeepholeRadius(GLfloat peepholeRadius)
-{
-    Q_D(RenderWidget);
-    d->peepholeRadius = peepholeRadius;
-    updateGL();
-}
-
-
-QString RenderWidget::glVersionString(void) const
-{
-    return QString("%1.%2").arg(d_ptr->glVersionMajor).arg(d_ptr->glVersionMinor);
-}
-
-
-void RenderWidget::setGazeSamples(const Samples &gazeSamples)
-{
-    Q_D(RenderWidget);
-    d->gazeSamples = gazeSamples;
-}
-
-
-void RenderWidget::updateViewport(int w, int h)
-{
-    Q_D(RenderWidget);
-    const QSizeF &size = QSizeF(d->frameSize);
-    const QPoint &topLeft = QPoint(w - size.width(), h - size.height()) / 2;
-    d->viewport = QRect(topLeft, size.toSize());
-    glViewport(d->viewport.x(), d->viewport.y(), d->viewport.width(), d->viewport.height());
-    d->resolution = QSizeF(d->viewport.size());
-    foreach (Kernel *k, d->kernels) {
-        if (!k->isFunctional())
-            break;
-        k->program->setUniformValue(k->uLocResolution, d->resolution);
-    }
-    updateGL();
-}
-
-
-void RenderWidget::updateViewport(const QSize& size)
-{
-    updateViewport(size.width(), size.height());
-}
-
-
-void RenderWidget::updateViewport(void)
-{
-    updateViewport(width(), height());
-}
-
-
-void RenderWidget::resizeEvent(QResizeEvent* e)
-{
-    updateViewport(e->size());
-}
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include "sample.h"
+#include "renderwidget.h"
+#include "util.h"
+#include "main.h"
+#include "kernel.h"
+#include "decoderthread.h"
+
+#include <QtCore/QDebug>
+#include <QtOpenGL>
+#include <QGLFramebufferObject>
+#include <QFile>
+#include <QTextStream>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class RenderWidgetPrivate {
+public:
+    explicit RenderWidgetPrivate(void)
+        : firstPaintEvent(true)
+        , yuvKernel(nullptr)
+        , copyKernel(nullptr)
+        , textureHandle(0)
+        , frameIsYUV(false)
+        , frameColorRange(VideoFrame::LimitedRange)
+        , frameColorMatrix(VideoFrame::BT601)
+        , glVersionMajor(0)
+        , glVersionMinor(0)
+        , gazePoint(0.5, 0.5)
+        , peepholeRadius(0.2f) // 0.0 .. 1.0
+        , uploadBytes(0)
+        , uploadFrames(0)
+    {
+        fbo[0] = fbo[1] = nullptr;
+        targetSizeTimer.setSingleShot(true);
+        targetSizeTimer.setInterval(RenderWidget::TargetSizeDelayMs);
+    }
+    QSize frameSize;
+    QColor backgroundColor;
+    bool firstPaintEvent;
+    KernelList kernels;
+    // the passes before the last render into these by turns, so that none reads the texture it writes
+    QGLFramebufferObject *fbo[2];
+    // converts YUV frames to RGB in a pass of its own, so that the filters only ever read RGB
+    Kernel *yuvKernel;
+    // plain copy, for when there's nothing else to do
+    Kernel *copyKernel;
+    GLuint textureHandle;
+    GLuint planeTextureHandles[VideoFrame::MaxPlanes];
+    QSize planeTextureSize;
+    bool frameIsYUV;
+    VideoFrame::ColorRange frameColorRange;
+    VideoFrame::ColorMatrix frameColorMatrix;
+    QSizeF resolution;
+    QRect viewport;
+    GLint glVersionMajor;
+    GLint glVersionMinor;
+    QPointF gazePoint;
+    GLfloat peepholeRadius;
+    Samples gazeSamples;
+    QTimer targetSizeTimer;
+    QSize reportedTargetSize;
+    // texture upload bandwidth, measured in windows of a second
+    QElapsedTimer uploadTimer;
+    qint64 uploadBytes;
+    int uploadFrames;
+
+    virtual ~RenderWidgetPrivate()
+    {
+        safeDelete(fbo[0]);
+        safeDelete(fbo[1]);
+        safeDelete(yuvKernel);
+        safeDelete(copyKernel);
+    }
+};
+
+
+RenderWidget::RenderWidget(QWidget *parent)
+    : QGLWidget(QGLFormat(QGL::SingleBuffer | QGL::NoDepthBuffer
+                          | QGL::AlphaChannel | QGL::NoAccumBuffer
+                          | QGL::NoStencilBuffer | QGL::NoStereoBuffers
+                          | QGL::HasOverlay |QGL::NoSampleBuffers), parent)
+    , d_ptr(new RenderWidgetPrivate)
+{
+    Q_D(RenderWidget);
+    setWindowTitle(QString("%1 - Live Preview").arg(AppName));
+    QObject::connect(&d->targetSizeTimer, SIGNAL(timeout()), SLOT(reportTargetSize()));
+}
+
+
+RenderWidget::~RenderWidget()
+{
+    // ...
+}
+
+
+void RenderWidget::makeFBO(void)
+{
+    Q_D(RenderWidget);
+    makeCurrent();
+    for (int i = 0; i < 2; ++i)
+        if (d->fbo[i] == nullptr || d->fbo[i]->size() != d->frameSize)
+            safeRenew(d->fbo[i], new QGLFramebufferObject(d->frameSize));
+}
+
+
+void RenderWidget::resizeGL(int w, int h)
+{
+    updateViewport(w, h);
+}
+
+
+void RenderWidget::initializeGL(void)
+{
+    Q_D(RenderWidget);
+    initializeGLFunctions();
+    glGetIntegerv(GL_MAJOR_VERSION, &d->glVersionMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &d->glVersionMinor);
+    qglClearColor(d->backgroundColor);
+    glEnable(GL_TEXTURE_2D);
+    glDepthMask(GL_FALSE);
+
+    // make texture
+    glGenTextures(1, &d->textureHandle);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, d->textureHandle);
+
+    // configure texture
+    makeCurrent();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+    // make and configure textures for Y, U and V planes
+    glGenTextures(VideoFrame::MaxPlanes, d->planeTextureHandles);
+    for (int i = 0; i < VideoFrame::MaxPlanes; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, d->planeTextureHandles[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    // load kernels
+    auto makeKernel = [](const QString &name) -> Kernel * {
+        Kernel *kernel;
+        kernel = new Kernel;
+        kernel->setShaders(":/shaders/default.vert",
+                           QString(":/shaders/%1.frag").arg(name));
+        qDebug() << "PROGRAM LINKED:" << kernel->isFunctional();
+        if (kernel->isFunctional())
+            return kernel;
+        delete kernel;
+        return nullptr;
+    };
+    auto addKernel = [&d, &makeKernel](const QString &name) {
+        Kernel *kernel = makeKernel(name);
+        if (kernel != nullptr)
+            d->kernels.append(kernel);
+    };
+    d->yuvKernel = makeKernel("yuv2rgb");
+    d->copyKernel = makeKernel("default");
+
+#if FILTER_FADE_TO_BLACK
+    addKernel("fade2black");
+#elif FILTER_BLUR
+    addKernel("hblur");
+    addKernel("vblur");
+#endif
+}
+
+
+void RenderWidget::paintGL(void)
+{
+    Q_D(RenderWidget);
+    if (d->firstPaintEvent) {
+        d->firstPaintEvent = false;
+        emit ready();
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+
+    if (d->fbo[0] == nullptr)
+        return;
+
+    // YUV frames are converted first, then come the filters; RGB frames
+    // are copied if there's no filter. The last pass renders into the
+    // viewport, the ones before at frame resolution into an FBO.
+    QList<Kernel *> passes;
+    if (d->frameIsYUV && d->yuvKernel != nullptr)
+        passes.append(d->yuvKernel);
+    foreach (Kernel *k, d->kernels) {
+        if (k->isFunctional())
+            passes.append(k);
+    }
+    if (passes.isEmpty() && d->copyKernel != nullptr)
+        passes.append(d->copyKernel);
+    if (d->frameIsYUV) {
+        for (int i = 0; i < VideoFrame::MaxPlanes; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, d->planeTextureHandles[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+    else {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, d->textureHandle);
+    }
+    const QSizeF frameResolution(d->frameSize);
+    for (int i = 0; i < passes.count(); ++i) {
+        Kernel *k = passes.at(i);
+        const bool last = (i == passes.count() - 1);
+        QGLFramebufferObject *target = last ? nullptr : d->fbo[i % 2];
+        if (target != nullptr) {
+            target->bind();
+            glViewport(0, 0, d->frameSize.width(), d->frameSize.height());
+        }
+        else {
+            glViewport(d->viewport.x(), d->viewport.y(), d->viewport.width(), d->viewport.height());
+        }
+        // uniforms go to the bound program, so bind first
+        k->program->bind();
+        k->program->setUniformValue(k->uLocTexture, 0);
+        if (k == d->yuvKernel) {
+            k->program->setUniformValue(k->uLocTextureU, 1);
+            k->program->setUniformValue(k->uLocTextureV, 2);
+            k->program->setUniformValue(k->uLocFullRange, d->frameColorRange == VideoFrame::FullRange);
+            k->program->setUniformValue(k->uLocBT709, d->frameColorMatrix == VideoFrame::BT709);
+        }
+        k->program->setUniformValue(k->uLocGazePoint, d->gazePoint);
+        k->program->setUniformValue(k->uLocPeepholeRadius, d->peepholeRadius);
+        k->program->setUniformValue(k->uLocResolution, last ? d->resolution : frameResolution);
+        // uploaded frames are stored top row first, FBO textures bottom row first
+        k->program->setAttributeArray(Kernel::ATEXCOORD, i == 0 ? Kernel::TexCoords4FBO : Kernel::TexCoords);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        if (target != nullptr) {
+            target->release();
+            glBindTexture(GL_TEXTURE_2D, target->texture());
+        }
+    }
+}
+
+
+void RenderWidget::closeEvent(QCloseEvent *e)
+{
+    e->accept();
+}
+
+
+void RenderWidget::setFrame(const VideoFrame &frame)
+{
+    Q_D(RenderWidget);
+    if (frame.isRGB()) {
+        // 32 bit RGB formats share the same memory layout and can be uploaded as GL_BGRA without conversion
+        d->frameSize = frame.size();
+        makeFBO();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, d->textureHandle);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.bytesPerLine(0) / 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame.size().width(), frame.size().height(), 0, GL_BGRA, GL_UNSIGNED_BYTE, frame.bits(0));
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        d->frameIsYUV = false;
+        d->uploadBytes += 4 * frame.size().width() * frame.size().height();
+    }
+    else if (!frame.isNull()) {
+        d->frameSize = frame.size();
+        makeFBO();
+        // (re)allocate textures only if the frame size changes, otherwise just replace their contents
+        const bool reallocate = d->planeTextureSize != frame.size();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int i = 0; i < frame.planeCount(); ++i) {
+            const QSize &planeSize = frame.planeSize(i);
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, d->planeTextureHandles[i]);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.bytesPerLine(i));
+            if (reallocate)
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, planeSize.width(), planeSize.height(), 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, frame.bits(i));
+            else
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planeSize.width(), planeSize.height(), GL_LUMINANCE, GL_UNSIGNED_BYTE, frame.bits(i));
+            d->uploadBytes += planeSize.width() * planeSize.height();
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glActiveTexture(GL_TEXTURE0);
+        d->planeTextureSize = frame.size();
+        d->frameIsYUV = true;
+        d->frameColorRange = frame.colorRange;
+        d->frameColorMatrix = frame.colorMatrix;
+    }
+    if (!frame.isNull()) {
+        ++d->uploadFrames;
+        if (!d->uploadTimer.isValid()) {
+            d->uploadTimer.start();
+        }
+        else if (d->uploadTimer.elapsed() > 1000) {
+            qDebug() << "RenderWidget: uploading" << 1e3 * d->uploadBytes / d->uploadTimer.elapsed() / 1024 / 1024 << "MB/s,"
+                     << d->uploadFrames << "frames of" << d->frameSize << "shown at" << d->viewport.size();
+            d->uploadBytes = 0;
+            d->uploadFrames = 0;
+            d->uploadTimer.restart();
+        }
+    }
+    updateViewport();
+}
+
+
+void RenderWidget::setGazePoint(const QPointF &gazePoint)
+{
+    Q_D(RenderWidget);
+    d->gazePoint = gazePoint;
+    updateGL();
+}
+
+
+void RenderWidget::setPeepholeRadius(GLfloat peepholeRadius)
+{
+    Q_D(RenderWidget);
+    d->peepholeRadius = peepholeRadius;
+    updateGL();
+}
+
+
+QString RenderWidget::glVersionString(void) const
+{
+    return QString("%1.%2").arg(d_ptr->glVersionMajor).arg(d_ptr->glVersionMinor);
+}
+
+
+void RenderWidget::setGazeSamples(const Samples &gazeSamples)
+{
+    Q_D(RenderWidget);
+    d->gazeSamples = gazeSamples;
+}
+
+
+QSize RenderWidget::targetSize(void) const
+{
+    return size() * devicePixelRatio();
+}
+
+
+// The frame is scaled to fit the widget with its aspect ratio kept.
+void RenderWidget::updateViewport(int w, int h)
+{
+    Q_D(RenderWidget);
+    const QSize &size = d->frameSize.isEmpty() ? QSize(w, h) : d->frameSize.scaled(w, h, Qt::KeepAspectRatio);
+    const QPoint &topLeft = QPoint(w - size.width(), h - size.height()) / 2;
+    d->viewport = QRect(topLeft, size);
+    glViewport(d->viewport.x(), d->viewport.y(), d->viewport.width(), d->viewport.height());
+    d->resolution = QSizeF(d->viewport.size());
+    updateGL();
+}
+
+
+void RenderWidget::updateViewport(const QSize& size)
+{
+    updateViewport(size.width(), size.height());
+}
+
+
+void RenderWidget::updateViewport(void)
+{
+    updateViewport(width(), height());
+}
+
+
+void RenderWidget::resizeEvent(QResizeEvent* e)
+{
+    Q_D(RenderWidget);
+    updateViewport(e->size());
+    d->targetSizeTimer.start();
+}
+
+
+void RenderWidget::reportTargetSize(void)
+{
+    Q_D(RenderWidget);
+    const QSize &size = targetSize();
+    if (size == d->reportedTargetSize)
+        return;
+    d->reportedTargetSize = size;
+    emit targetSizeChanged(size);
+}
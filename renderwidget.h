@@ -1,64 +1,74 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#ifndef __RENDERWIDGET_H_
-#define __RENDERWIDGET_H_
-
-#include <QGLFunctions>
-#include <QGLWidget>
-#include <QPoint>
-#include <QPointF>
-#include <QString>
-#include <QImage>
-#include <QResizeEvent>
-#include <QCloseEvent>
-#include <QScopedPointer>
-
-#include "sample.h"
-
-
-class RenderWidgetPrivate;
-
-class RenderWidget : public QGLWidget, protected QGLFunctions
-{
-    Q_OBJECT
-public:
-    explicit RenderWidget(QWidget *parent = nullptr);
-    virtual ~RenderWidget();
-    virtual QSize minimumSizeHint(void) const { return QSize(240, 160); }
-    virtual QSize sizeHint(void) const  { return QSize(640, 480); }
-    void updateViewport(void);
-    QString glVersionString(void) const;
-    void setGazeSamples(const Samples&);
-
-signals:
-    void ready(void);
-    void vertexShaderError(QString);
-    void fragmentShaderError(QString);
-    void linkerError(QString);
-
-public slots:
-    void setFrame(const QImage &, int);
-    void setGazePoint(const QPointF &);
-    void setPeepholeRadius(GLfloat);
-
-protected:
-    void resizeEvent(QResizeEvent *);
-    void initializeGL(void);
-    void resizeGL(int, int);
-    void paintGL(void);
-    void closeEvent(QCloseEvent *);
-
-private: // methods
-    void updateViewport(const QSize&);
-    void updateViewport(int w, int h);
-    void makeFBO();
-
-private:
-    QScopedPointer<RenderWidgetPrivate> d_ptr;
-    Q_DECLARE_PRIVATE(RenderWidget)
-    Q_DISABLE_COPY(RenderWidget)
-
-};
-
-#endif // __RENDERWIDGET_H_
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __RENDERWIDGET_H_
+#define __RENDERWIDGET_H_
+
+#include <QGLFunctions>
+#include <QGLWidget>
+#include <QPoint>
+#include <QPointF>
+#include <QString>
+#include <QImage>
+#include <QResizeEvent>
+#include <QCloseEvent>
+#include <QScopedPointer>
+
+#include "sample.h"
+#include "videoframe.h"
+
+
+class RenderWidgetPrivate;
+
+class RenderWidget : public QGLWidget, protected QGLFunctions
+{
+    Q_OBJECT
+public:
+    // delay before a new target size is reported, so that dragging the window's border doesn't make the decoder rescale on every step
+    static const int TargetSizeDelayMs = 150;
+
+    explicit RenderWidget(QWidget *parent = nullptr);
+    virtual ~RenderWidget();
+    virtual QSize minimumSizeHint(void) const { return QSize(240, 160); }
+    virtual QSize sizeHint(void) const  { return QSize(640, 480); }
+    void updateViewport(void);
+    QString glVersionString(void) const;
+    void setGazeSamples(const Samples&);
+    QSize targetSize(void) const;
+
+signals:
+    void ready(void);
+    void vertexShaderError(QString);
+    void fragmentShaderError(QString);
+    void linkerError(QString);
+    // the size in pixels the frames are displayed at
+    void targetSizeChanged(const QSize &);
+
+public slots:
+    void setFrame(const VideoFrame &);
+    void setGazePoint(const QPointF &);
+    void setPeepholeRadius(GLfloat);
+
+protected:
+    void resizeEvent(QResizeEvent *);
+    void initializeGL(void);
+    void resizeGL(int, int);
+    void paintGL(void);
+    void closeEvent(QCloseEvent *);
+
+private slots:
+    void reportTargetSize(void);
+
+private: // methods
+    void updateViewport(const QSize&);
+    void updateViewport(int w, int h);
+    void makeFBO();
+
+private:
+    QScopedPointer<RenderWidgetPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(RenderWidget)
+    Q_DISABLE_COPY(RenderWidget)
+
+};
+
+#endif // __RENDERWIDGET_H_
@@ -1,29 +1,57 @@
-// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
-// All rights reserved.
-
-#ifndef __SAMPLE_H_
-#define __SAMPLE_H_
-
-#include <QVector>
-
-
-class Sample {
-public:
-    Sample(void)
-        : timestamp(0)
-    { /* ... */ }
-    Sample(const QPointF &p, qint64 t)
-        : pos(p)
-        , timestamp(t)
-    { /* ... */ }
-    Sample(const Sample& other)
-        : pos(other.pos)
-        , timestamp(other.timestamp)
-    { /* ... */ }
-    QPointF pos;
-    qint64 timestamp;
-};
-
-typedef QVector<Sample> Samples;
-
-#endif // __SAMPLE_H_
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __SAMPLE_H_
+#define __SAMPLE_H_
+
+#include <QVector>
+#include <QPointF>
+
+
+class Sample {
+public:
+    Sample(void)
+        : timestamp(0)
+    { /* ... */ }
+    Sample(const QPointF &p, qint64 t)
+        : pos(p)
+        , timestamp(t)
+    { /* ... */ }
+    Sample(const Sample& other)
+        : pos(other.pos)
+        , timestamp(other.timestamp)
+    { /* ... */ }
+    QPointF pos;
+    qint64 timestamp;
+};
+
+typedef QVector<Sample> Samples;
+
+
+// Gaze samples stored column by column, as the importer produces them
+// and the analysis code prefers them.
+class GazeColumns {
+public:
+    int count(void) const
+    {
+        return timestamps.count();
+    }
+    void clear(void)
+    {
+        timestamps.clear();
+        x.clear();
+        y.clear();
+    }
+    Samples toSamples(void) const
+    {
+        Samples samples(count());
+        for (int i = 0; i < samples.count(); ++i)
+            samples[i] = Sample(QPointF(x.at(i), y.at(i)), timestamps.at(i));
+        return samples;
+    }
+    QVector<qint64> timestamps;
+    QVector<double> x;
+    QVector<double> y;
+};
+
+#endif // __SAMPLE_H_
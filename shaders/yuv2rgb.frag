@@ -0,0 +1,28 @@
+// Planar YUV to RGB conversion fragment shader.
+//
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+varying vec2 vTexCoord;
+uniform sampler2D uTexture;
+uniform sampler2D uTextureU;
+uniform sampler2D uTextureV;
+uniform bool uFullRange;
+uniform bool uBT709;
+
+void main(void)
+{
+    float y = texture2D(uTexture, vTexCoord).r;
+    float u = texture2D(uTextureU, vTexCoord).r - 0.5;
+    float v = texture2D(uTextureV, vTexCoord).r - 0.5;
+    // limited range: Y in 16..235, U and V in 16..240
+    if (!uFullRange) {
+        y = 1.164 * (y - 0.0625);
+        u *= 1.138;
+        v *= 1.138;
+    }
+    if (uBT709)
+        gl_FragColor = vec4(y + 1.575 * v, y - 0.187 * u - 0.468 * v, y + 1.856 * u, 1.0);
+    else
+        gl_FragColor = vec4(y + 1.402 * v, y - 0.344 * u - 0.714 * v, y + 1.772 * u, 1.0);
+}
@@ -0,0 +1,235 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+#include <QThread>
+#include <QVector>
+
+#include "streamgroup.h"
+#include "framescheduler.h"
+
+
+// Seeks all decoders of the group. They are handed over to this thread
+// for that time: the group waits for it before it touches them again.
+class SeekThread : public QThread {
+public:
+    SeekThread(void)
+        : ms(0)
+    { /* ... */ }
+    QVector<DecoderThread *> decoders;
+    qint64 ms;
+protected:
+    virtual void run(void)
+    {
+        foreach (DecoderThread *decoder, decoders)
+            decoder->seek(ms, false);
+    }
+};
+
+
+class StreamGroupPrivate {
+public:
+    StreamGroupPrivate(void)
+        : threadsPerStream(0)
+        , pendingSeekMs(-1)
+    { /* ... */ }
+    ~StreamGroupPrivate()
+    {
+        clear();
+    }
+    void clear(void)
+    {
+        seekThread.wait();
+        pendingSeekMs = -1;
+        foreach (DecoderThread *decoder, decoders)
+            decoder->abort();
+        qDeleteAll(schedulers);
+        qDeleteAll(decoders);
+        schedulers.clear();
+        decoders.clear();
+    }
+    PresentationClock clock;
+    QVector<DecoderThread *> decoders;
+    QVector<FrameScheduler *> schedulers;
+    int threadsPerStream;
+    SeekThread seekThread;
+    // position asked for while the seek thread was busy, -1 if none
+    qint64 pendingSeekMs;
+};
+
+
+StreamGroup::StreamGroup(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new StreamGroupPrivate)
+{
+    Q_D(StreamGroup);
+    QObject::connect(&d->seekThread, SIGNAL(finished()), SLOT(seekFinished()));
+}
+
+
+StreamGroup::~StreamGroup()
+{
+    // ...
+}
+
+
+// Opens all videos and starts them paused at their first frame.
+bool StreamGroup::open(const QStringList &filenames)
+{
+    Q_D(StreamGroup);
+    close();
+    if (filenames.isEmpty())
+        return false;
+    // frame threading adds a frame of latency per thread, so rather give every stream a few threads than one stream many
+    d->threadsPerStream = qMax(1, QThread::idealThreadCount() / filenames.count());
+    qint64 durationMs = 0;
+    foreach (const QString &filename, filenames) {
+        DecoderThread *decoder = new DecoderThread;
+        emit streamCreated(decoder);
+        decoder->setDecoderThreads(d->threadsPerStream, DecoderThread::FrameThreading);
+        // the cache budget is meant for all streams together
+        decoder->setFrameCacheBudget(decoder->frameCache()->budget() / filenames.count());
+        decoder->setPresentationClock(&d->clock);
+        FrameScheduler *scheduler = new FrameScheduler(decoder->frameQueue(), &d->clock);
+        d->decoders.append(decoder);
+        d->schedulers.append(scheduler);
+        if (!decoder->openVideo(filename)) {
+            qWarning() << "StreamGroup: cannot open" << filename;
+            close();
+            return false;
+        }
+        durationMs = qMax(durationMs, decoder->duration());
+        QObject::connect(decoder, SIGNAL(frameAvailable()), scheduler, SLOT(schedule()));
+        QObject::connect(scheduler, SIGNAL(frameReady(VideoFrame)), SLOT(streamFrameReady(VideoFrame)));
+    }
+    QObject::connect(d->schedulers.first(), SIGNAL(framePresented(qint64, qint64)), SLOT(masterFramePresented(qint64)));
+    qDebug() << "StreamGroup: decoding" << count() << "streams with" << d->threadsPerStream << "threads each";
+    emit durationChanged(durationMs);
+    d->clock.invalidate();
+    foreach (DecoderThread *decoder, d->decoders) {
+        decoder->setPaused(true);
+        decoder->start();
+    }
+    return true;
+}
+
+
+void StreamGroup::close(void)
+{
+    Q_D(StreamGroup);
+    d->clear();
+}
+
+
+int StreamGroup::count(void) const
+{
+    return d_ptr->decoders.count();
+}
+
+
+DecoderThread *StreamGroup::stream(int index) const
+{
+    return d_ptr->decoders.at(index);
+}
+
+
+PresentationClock *StreamGroup::presentationClock(void)
+{
+    return &d_ptr->clock;
+}
+
+
+int StreamGroup::threadsPerStream(void) const
+{
+    return d_ptr->threadsPerStream;
+}
+
+
+bool StreamGroup::isPaused(void) const
+{
+    return d_ptr->decoders.isEmpty() || d_ptr->decoders.first()->isPaused();
+}
+
+
+qreal StreamGroup::speed(void) const
+{
+    return d_ptr->clock.speed();
+}
+
+
+void StreamGroup::setPaused(bool paused)
+{
+    Q_D(StreamGroup);
+    d->seekThread.wait();
+    foreach (DecoderThread *decoder, d->decoders)
+        decoder->setPaused(paused);
+}
+
+
+// Returns right away. A seek asked for while the previous one is still
+// under way replaces any other waiting seek.
+void StreamGroup::seek(qint64 ms)
+{
+    Q_D(StreamGroup);
+    if (d->decoders.isEmpty())
+        return;
+    if (d->seekThread.isRunning()) {
+        d->pendingSeekMs = ms;
+        return;
+    }
+    // once for all streams, the first one to present after the seek sets it again
+    d->clock.invalidate();
+    d->seekThread.decoders = d->decoders;
+    d->seekThread.ms = ms;
+    d->seekThread.start();
+}
+
+
+void StreamGroup::seekFinished(void)
+{
+    Q_D(StreamGroup);
+    if (d->seekThread.isRunning() || d->pendingSeekMs < 0)
+        return;
+    const qint64 ms = d->pendingSeekMs;
+    d->pendingSeekMs = -1;
+    seek(ms);
+}
+
+
+// Seeks all streams `n` frames of the master away from the frame on
+// screen, which is where the paused clock stands.
+void StreamGroup::stepFrame(int n)
+{
+    Q_D(StreamGroup);
+    if (d->decoders.isEmpty() || n == 0)
+        return;
+    const DecoderThread *master = d->decoders.first();
+    const qint64 t = d->clock.isValid() ? d->clock.time() : master->position();
+    seek(qMax(Q_INT64_C(0), t + n * qMax(Q_INT64_C(1), master->frameDuration())));
+}
+
+
+// The first decoder already turns the shared clock around; the others
+// still turn around as they keep track of their direction themselves.
+void StreamGroup::setSpeed(qreal speed)
+{
+    Q_D(StreamGroup);
+    d->seekThread.wait();
+    foreach (DecoderThread *decoder, d->decoders)
+        decoder->setSpeed(speed);
+}
+
+
+void StreamGroup::streamFrameReady(const VideoFrame &frame)
+{
+    Q_D(StreamGroup);
+    const int index = d->schedulers.indexOf(qobject_cast<FrameScheduler *>(sender()));
+    if (index >= 0)
+        emit frameReady(index, frame);
+}
+
+
+void StreamGroup::masterFramePresented(qint64 pts)
+{
+    emit positionChanged(pts);
+}
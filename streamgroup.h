@@ -0,0 +1,67 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __STREAMGROUP_H_
+#define __STREAMGROUP_H_
+
+#include <QObject>
+#include <QStringList>
+#include <QScopedPointer>
+
+#include "videoframe.h"
+#include "decoderthread.h"
+#include "presentationclock.h"
+
+
+class StreamGroupPrivate;
+
+// Plays several videos in sync, e.g. a scene camera and a face camera.
+// Every video has a decoder and a frame scheduler of its own, but all of
+// them follow one presentation clock: whichever stream presents first
+// after a seek sets it, the others line up with it. The cores are shared
+// among the decoders, so the number of decoding threads doesn't grow with
+// the number of streams. Stream 0 is the master whose position is
+// reported. Seeks run in a thread of their own, as repositioning every
+// stream one after the other would keep the GUI waiting.
+class StreamGroup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StreamGroup(QObject *parent = nullptr);
+    ~StreamGroup();
+
+    bool open(const QStringList &filenames);
+    void close(void);
+    int count(void) const;
+    DecoderThread *stream(int index) const;
+    PresentationClock *presentationClock(void);
+    int threadsPerStream(void) const;
+    bool isPaused(void) const;
+    qreal speed(void) const;
+
+signals:
+    // emitted for every decoder before it opens its video, so that settings can be applied to it
+    void streamCreated(DecoderThread *);
+    void frameReady(int stream, const VideoFrame &);
+    void positionChanged(qint64);
+    void durationChanged(qint64);
+
+public slots:
+    void setPaused(bool);
+    void seek(qint64 ms);
+    void stepFrame(int n);
+    void setSpeed(qreal);
+
+private slots:
+    void seekFinished(void);
+    void streamFrameReady(const VideoFrame &);
+    void masterFramePresented(qint64 pts);
+
+private:
+    QScopedPointer<StreamGroupPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(StreamGroup)
+    Q_DISABLE_COPY(StreamGroup)
+
+};
+
+#endif // __STREAMGROUP_H_
@@ -0,0 +1,198 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __VIDEOFRAME_H_
+#define __VIDEOFRAME_H_
+
+#include <QSize>
+#include <QImage>
+#include <QMetaType>
+#include <cstring>
+
+#include "framepool.h"
+
+
+// Reference-counted handle to the pixels of a video frame. Copying a
+// VideoFrame never copies pixels; the memory behind it, be it a pooled
+// buffer or a decoded AVFrame, is released when the last handle goes
+// away.
+class VideoFrame {
+public:
+    enum PixelFormat {
+        Format_Invalid,
+        Format_YUV420P,
+        Format_RGB32,
+        Format_ARGB32,
+        Format_ARGB32_Premultiplied
+    };
+    // How the samples of YUV frames are to be turned into RGB
+    enum ColorRange {
+        LimitedRange,
+        FullRange
+    };
+    enum ColorMatrix {
+        BT601,
+        BT709
+    };
+    static const int MaxPlanes = 3;
+    static const int LineAlignment = 32;
+
+    VideoFrame(void)
+        : pts(0)
+        , number(0)
+        , colorRange(LimitedRange)
+        , colorMatrix(BT601)
+        , mPixelFormat(Format_Invalid)
+    {
+        for (int i = 0; i < MaxPlanes; ++i) {
+            mPlane[i] = nullptr;
+            mLinesize[i] = 0;
+        }
+    }
+    // Takes the buffer from `pool` if given, otherwise allocates a buffer of its own.
+    VideoFrame(const QSize &size, PixelFormat pixelFormat, FramePool *pool = nullptr)
+        : pts(0)
+        , number(0)
+        , colorRange(LimitedRange)
+        , colorMatrix(BT601)
+        , mSize(size)
+        , mPixelFormat(pixelFormat)
+    {
+        int offset[MaxPlanes];
+        const int bufSize = layout(size, pixelFormat, offset, mLinesize);
+        mBuffer = (pool != nullptr) ? pool->acquire(bufSize) : FramePool::allocate(bufSize);
+        for (int i = 0; i < MaxPlanes; ++i)
+            mPlane[i] = (i < planeCount()) ? mBuffer->data + offset[i] : nullptr;
+    }
+    // Refers to planes living in memory someone else owns. `owner` keeps
+    // that memory alive; its deleter releases it.
+    VideoFrame(const QSize &size, PixelFormat pixelFormat, uchar *const plane[], const int linesize[], const FrameBufferPtr &owner)
+        : pts(0)
+        , number(0)
+        , colorRange(LimitedRange)
+        , colorMatrix(BT601)
+        , mSize(size)
+        , mPixelFormat(pixelFormat)
+        , mBuffer(owner)
+    {
+        for (int i = 0; i < MaxPlanes; ++i) {
+            mPlane[i] = (i < planeCount()) ? plane[i] : nullptr;
+            mLinesize[i] = (i < planeCount()) ? linesize[i] : 0;
+        }
+    }
+
+    bool isNull(void) const { return mPixelFormat == Format_Invalid || mSize.isEmpty(); }
+    PixelFormat pixelFormat(void) const { return mPixelFormat; }
+    const QSize &size(void) const { return mSize; }
+    int planeCount(void) const { return planeCount(mPixelFormat); }
+    QSize planeSize(int plane) const { return planeSize(mSize, mPixelFormat, plane); }
+    int bytesPerLine(int plane) const { return mLinesize[plane]; }
+    uchar *bits(int plane) { return mPlane[plane]; }
+    const uchar *bits(int plane) const { return mPlane[plane]; }
+    bool isRGB(void) const { return isRGB(mPixelFormat); }
+
+    // Copies the pixels into a buffer taken from `pool` if given, otherwise
+    // into one of its own. Unlike the frame itself the copy keeps neither a
+    // pool's nor a decoder's buffer in use.
+    VideoFrame copy(FramePool *pool = nullptr) const
+    {
+        if (isNull())
+            return VideoFrame();
+        VideoFrame frame(mSize, mPixelFormat, pool);
+        frame.pts = pts;
+        frame.number = number;
+        frame.colorRange = colorRange;
+        frame.colorMatrix = colorMatrix;
+        for (int i = 0; i < planeCount(); ++i) {
+            const QSize &sz = planeSize(i);
+            const int lineBytes = sz.width() * bytesPerPixel(mPixelFormat);
+            for (int y = 0; y < sz.height(); ++y)
+                memcpy(frame.bits(i) + y * frame.bytesPerLine(i), bits(i) + y * bytesPerLine(i), size_t(lineBytes));
+        }
+        return frame;
+    }
+
+    // Wraps the pixels of an RGB frame into a QImage without copying them.
+    // The image keeps the frame alive.
+    QImage toImage(void) const
+    {
+        QImage::Format format;
+        switch (mPixelFormat) {
+        case Format_RGB32:
+            format = QImage::Format_RGB32;
+            break;
+        case Format_ARGB32:
+            format = QImage::Format_ARGB32;
+            break;
+        case Format_ARGB32_Premultiplied:
+            format = QImage::Format_ARGB32_Premultiplied;
+            break;
+        default:
+            return QImage();
+        }
+        return QImage(bits(0), mSize.width(), mSize.height(), bytesPerLine(0), format, releaseImageFrame, new VideoFrame(*this));
+    }
+
+    static bool isRGB(PixelFormat pixelFormat)
+    {
+        return pixelFormat == Format_RGB32 || pixelFormat == Format_ARGB32 || pixelFormat == Format_ARGB32_Premultiplied;
+    }
+    static int planeCount(PixelFormat pixelFormat)
+    {
+        return pixelFormat == Format_YUV420P ? 3 : isRGB(pixelFormat) ? 1 : 0;
+    }
+    static QSize planeSize(const QSize &size, PixelFormat pixelFormat, int plane)
+    {
+        if (plane == 0 || pixelFormat != Format_YUV420P)
+            return size;
+        return QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+    }
+    static int bytesPerPixel(PixelFormat pixelFormat)
+    {
+        return isRGB(pixelFormat) ? 4 : 1;
+    }
+    // Calculates plane offsets and line sizes so that every line starts on an aligned address.
+    // Returns the number of bytes needed to hold all planes.
+    static int layout(const QSize &size, PixelFormat pixelFormat, int *offset, int *linesize)
+    {
+        int total = 0;
+        for (int i = 0; i < MaxPlanes; ++i) {
+            offset[i] = total;
+            linesize[i] = 0;
+            if (i >= planeCount(pixelFormat))
+                continue;
+            const QSize &sz = planeSize(size, pixelFormat, i);
+            linesize[i] = (sz.width() * bytesPerPixel(pixelFormat) + LineAlignment - 1) & ~(LineAlignment - 1);
+            total += linesize[i] * sz.height();
+            total = (total + FramePool::Alignment - 1) & ~(FramePool::Alignment - 1);
+        }
+        return total;
+    }
+    static int bufferSize(const QSize &size, PixelFormat pixelFormat = Format_YUV420P)
+    {
+        int offset[MaxPlanes];
+        int linesize[MaxPlanes];
+        return layout(size, pixelFormat, offset, linesize);
+    }
+
+    qint64 pts;
+    int number;
+    ColorRange colorRange;
+    ColorMatrix colorMatrix;
+
+private:
+    static void releaseImageFrame(void *frame)
+    {
+        delete reinterpret_cast<VideoFrame *>(frame);
+    }
+
+    QSize mSize;
+    PixelFormat mPixelFormat;
+    FrameBufferPtr mBuffer;
+    uchar *mPlane[MaxPlanes];
+    int mLinesize[MaxPlanes];
+};
+
+Q_DECLARE_METATYPE(VideoFrame)
+
+#endif // __VIDEOFRAME_H_
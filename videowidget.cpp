@@ -2,27 +2,28 @@
 // All rights reserved.
 
 #include <QtWidgets>
-#include <QVideoSurfaceFormat>
 
 #include "videowidget.h"
-#include "videowidgetsurface.h"
+#include "yuvconverter.h"
 #include "eyexhost.h"
-#include "util.h"
 
 class VideoWidgetPrivate {
 public:
     VideoWidgetPrivate()
-        : surface(nullptr)
-        , gazeSamples(nullptr)
+        : gazeSamples(nullptr)
+        , gazeStore(nullptr)
+        , gazeTime(0)
         , visualizeGaze(false)
         , leftMouseButtonPressed(false)
     { /* ... */ }
-    ~VideoWidgetPrivate()
-    {
-        safeDelete(surface);
-    }
-    VideoWidgetSurface *surface;
+    // the frame on screen, converted to RGB unless it is already
+    QImage image;
+    QRect targetRect;
     Samples *gazeSamples;
+    // a replayed recording, drawn at `gazeTime` instead of the live samples
+    const GazeStore *gazeStore;
+    GazeStore::Cursor gazeCursor;
+    qint64 gazeTime;
     bool visualizeGaze;
     bool leftMouseButtonPressed;
     QPoint position;
@@ -40,7 +41,6 @@ VideoWidget::VideoWidget(QWidget *parent)
     palette.setColor(QPalette::Background, Qt::black);
     setPalette(palette);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
-    d_ptr->surface = new VideoWidgetSurface(this);
 }
 
 
@@ -52,7 +52,42 @@ VideoWidget::~VideoWidget()
 
 QSize VideoWidget::sizeHint(void) const
 {
-    return d_ptr->surface->surfaceFormat().sizeHint();
+    return d_ptr->image.isNull() ? QWidget::sizeHint() : d_ptr->image.size();
+}
+
+
+// Size of the frame on screen, empty if there is none.
+QSize VideoWidget::frameSize(void) const
+{
+    return d_ptr->image.size();
+}
+
+
+void VideoWidget::setFrame(const VideoFrame &frame)
+{
+    Q_D(VideoWidget);
+    if (frame.isNull())
+        return;
+    const QSize oldSize = d->image.size();
+    d->image = frame.isRGB() ? frame.toImage() : YUVConverter::toImage(frame);
+    if (d->image.size() != oldSize) {
+        updateGeometry();
+        updateTargetRect();
+        update();
+    }
+    else {
+        update(d->targetRect);
+    }
+}
+
+
+void VideoWidget::updateTargetRect(void)
+{
+    Q_D(VideoWidget);
+    QSize size = d->image.size();
+    size.scale(this->size(), Qt::KeepAspectRatio);
+    d->targetRect = QRect(QPoint(), size);
+    d->targetRect.moveCenter(rect().center());
 }
 
 
@@ -62,6 +97,23 @@ void VideoWidget::setSamples(Samples *samples)
 }
 
 
+void VideoWidget::setGazeStore(const GazeStore *store)
+{
+    Q_D(VideoWidget);
+    d->gazeStore = store;
+    d->gazeCursor.setStore(store);
+}
+
+
+void VideoWidget::setGazeTime(qint64 ms)
+{
+    Q_D(VideoWidget);
+    d->gazeTime = ms;
+    if (d->visualizeGaze)
+        update();
+}
+
+
 void VideoWidget::setVisualisation(bool enabled)
 {
     d_ptr->visualizeGaze = enabled;
@@ -73,21 +125,21 @@ void VideoWidget::paintEvent(QPaintEvent *event)
     Q_D(VideoWidget);
     QPainter painter(this);
 
-    if (d_ptr->surface->isActive()) {
-        const QRect videoRect = d_ptr->surface->videoRect();
-        if (!videoRect.contains(event->rect())) {
+    if (!d->image.isNull()) {
+        if (!d->targetRect.contains(event->rect())) {
             QRegion region = event->region();
-            region = region.subtracted(videoRect);
+            region = region.subtracted(d->targetRect);
             QBrush brush = palette().background();
             foreach (const QRect &rect, region.rects())
                 painter.fillRect(rect, brush);
         }
-        d_ptr->surface->paint(&painter);
+        painter.drawImage(d->targetRect, d->image);
     }
     else {
         painter.fillRect(event->rect(), QColor(60, 60, 60));
     }
-    if (d->visualizeGaze && d->gazeSamples != nullptr) {
+    const bool replay = d->gazeStore != nullptr && !d->gazeStore->isEmpty();
+    if (d->visualizeGaze && (replay || d->gazeSamples != nullptr)) {
         auto easeInOut = [](float k) -> float {
             if ((k *= 2) < 1)
                 return 0.5 * k * k;
@@ -96,12 +148,13 @@ void VideoWidget::paintEvent(QPaintEvent *event)
         painter.setRenderHint(QPainter::Antialiasing);
         painter.setCompositionMode(QPainter::CompositionMode_Difference);
         painter.setPen(Qt::transparent);
-        const int nSamples = d->gazeSamples->count();
+        // while replaying, the trail ends at the sample belonging to the frame on screen
+        const int nSamples = replay ? d->gazeCursor.lowerBound(d->gazeTime + 1) : d->gazeSamples->count();
         const int maxSamples = qMin(nSamples, 10);
         QPointF sum;
         for (int i = 0; i < maxSamples; ++i) {
             painter.setBrush(QBrush(QColor(230, 80, 30, int(255 * easeInOut(float(i) / maxSamples)))));
-            QPointF pos = d->gazeSamples->at(nSamples - i - 1).pos;
+            QPointF pos = replay ? d->gazeStore->pos(nSamples - i - 1) : d->gazeSamples->at(nSamples - i - 1).pos;
             pos.setX(pos.x() * width());
             pos.setY(pos.y() * height());
             painter.drawEllipse(pos, 5, 5);
@@ -118,7 +171,8 @@ void VideoWidget::paintEvent(QPaintEvent *event)
 void VideoWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
-    d_ptr->surface->updateVideoRect();
+    updateTargetRect();
+    emit targetSizeChanged(event->size());
 }
 
 
@@ -156,8 +210,3 @@ void VideoWidget::mouseReleaseEvent(QMouseEvent *e)
     e->accept();
 }
 
-
-QAbstractVideoSurface *VideoWidget::videoSurface(void) const
-{
-    return d_ptr->surface;
-}
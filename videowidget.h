@@ -4,10 +4,12 @@
 #ifndef __VIDEOWIDGET_H_
 #define __VIDEOWIDGET_H_
 
-#include "videowidgetsurface.h"
+#include "videoframe.h"
 #include "eyexhost.h"
+#include "gazestore.h"
 
 #include <QWidget>
+#include <QImage>
 #include <QPointF>
 #include <QScopedPointer>
 #include <QMouseEvent>
@@ -15,6 +17,8 @@
 
 class VideoWidgetPrivate;
 
+// Shows the frames handed to setFrame() letterboxed, with the gaze
+// drawn on top if visualisation is switched on.
 class VideoWidget : public QWidget
 {
     Q_OBJECT
@@ -23,17 +27,20 @@ public:
     explicit VideoWidget(QWidget *parent = nullptr);
     virtual ~VideoWidget();
 
-    QAbstractVideoSurface *videoSurface(void) const;
-
     QSize sizeHint(void) const;
+    QSize frameSize(void) const;
 
     void setSamples(Samples*);
+    void setGazeStore(const GazeStore *);
+    void setGazeTime(qint64 ms);
 
 public slots:
+    void setFrame(const VideoFrame &);
     void setVisualisation(bool);
 
 signals:
     void virtualGazePointChanged(QPointF);
+    void targetSizeChanged(const QSize &);
 
 protected:
     void paintEvent(QPaintEvent *event);
@@ -42,6 +49,9 @@ protected:
     void mousePressEvent(QMouseEvent*);
     void mouseReleaseEvent(QMouseEvent*);
 
+private: // methods
+    void updateTargetRect(void);
+
 private:
     QScopedPointer<VideoWidgetPrivate> d_ptr;
     Q_DECLARE_PRIVATE(VideoWidget)
@@ -0,0 +1,283 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include <QtCore/QDebug>
+
+#include "yuvconverter.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define YUV_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+
+// Fixed point coefficients, scaled by 64, e.g. for BT.601 limited range:
+// R = 1.164 (Y - 16) + 1.596 (V - 128)
+// G = 1.164 (Y - 16) - 0.391 (U - 128) - 0.813 (V - 128)
+// B = 1.164 (Y - 16) + 2.018 (U - 128)
+// Products fit into 16 bits, so the SIMD kernels can work on 16 bit lanes.
+struct Coefficients {
+    int y0;
+    int cy;
+    int crv;
+    int cgu;
+    int cgv;
+    int cbu;
+};
+
+// indexed by VideoFrame::ColorMatrix and VideoFrame::ColorRange
+static const Coefficients coefficients[2][2] = {
+    { { 16, 74, 102, 25, 52, 129 }, { 0, 64, 90, 22, 46, 113 } },
+    { { 16, 74, 115, 14, 34, 135 }, { 0, 64, 101, 12, 30, 119 } }
+};
+
+typedef void (*RowConverter)(const uchar *y, const uchar *u, const uchar *v, int x0, int w, uchar *dst, const Coefficients &k);
+
+
+static inline uchar clamp8(int x)
+{
+    return uchar(x < 0 ? 0 : x > 255 ? 255 : x);
+}
+
+
+// Converts `w` pixels starting at column `x0`. `u` and `v` point to the start of the chroma rows.
+static void convertRowScalar(const uchar *y, const uchar *u, const uchar *v, int x0, int w, uchar *dst, const Coefficients &k)
+{
+    for (int x = x0; x < x0 + w; ++x) {
+        const int c = (y[x] - k.y0) * k.cy + 32;
+        const int d = u[x >> 1] - 128;
+        const int e = v[x >> 1] - 128;
+        dst[0] = clamp8((c + k.cbu * d) >> 6);
+        dst[1] = clamp8((c - k.cgu * d - k.cgv * e) >> 6);
+        dst[2] = clamp8((c + k.crv * e) >> 6);
+        dst[3] = 0xff;
+        dst += 4;
+    }
+}
+
+
+#ifdef YUV_X86
+TARGET_SSE41 static void convertRowSSE41(const uchar *y, const uchar *u, const uchar *v, int x0, int w, uchar *dst, const Coefficients &k)
+{
+    // chroma samples are shared by pairs of pixels starting at even columns
+    if ((x0 & 1) && w > 0) {
+        convertRowScalar(y, u, v, x0, 1, dst, k);
+        ++x0;
+        --w;
+        dst += 4;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8(char(0xff));
+    const __m128i y0 = _mm_set1_epi16(k.y0);
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(32);
+    const __m128i cy = _mm_set1_epi16(k.cy);
+    const __m128i crv = _mm_set1_epi16(k.crv);
+    const __m128i cgu = _mm_set1_epi16(k.cgu);
+    const __m128i cgv = _mm_set1_epi16(k.cgv);
+    const __m128i cbu = _mm_set1_epi16(k.cbu);
+    int x = x0;
+    for (; x + 8 <= x0 + w; x += 8) {
+        const __m128i yy = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)));
+        const __m128i uu4 = _mm_cvtsi32_si128(*reinterpret_cast<const int *>(u + (x >> 1)));
+        const __m128i vv4 = _mm_cvtsi32_si128(*reinterpret_cast<const int *>(v + (x >> 1)));
+        const __m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(uu4, uu4), zero), c128);
+        const __m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(vv4, vv4), zero), c128);
+        const __m128i c = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(yy, y0), cy), round);
+        // full range input may exceed 16 bits here, saturation takes care of that
+        const __m128i r = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(vv, crv)), 6);
+        const __m128i g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(c, _mm_mullo_epi16(uu, cgu)), _mm_mullo_epi16(vv, cgv)), 6);
+        const __m128i b = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(uu, cbu)), 6);
+        const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+        const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+        dst += 32;
+    }
+    convertRowScalar(y, u, v, x, x0 + w - x, dst, k);
+}
+
+
+TARGET_AVX2 static void convertRowAVX2(const uchar *y, const uchar *u, const uchar *v, int x0, int w, uchar *dst, const Coefficients &k)
+{
+    if ((x0 & 1) && w > 0) {
+        convertRowScalar(y, u, v, x0, 1, dst, k);
+        ++x0;
+        --w;
+        dst += 4;
+    }
+    const __m256i alpha = _mm256_set1_epi8(char(0xff));
+    const __m256i y0 = _mm256_set1_epi16(k.y0);
+    const __m256i c128 = _mm256_set1_epi16(128);
+    const __m256i round = _mm256_set1_epi16(32);
+    const __m256i cy = _mm256_set1_epi16(k.cy);
+    const __m256i crv = _mm256_set1_epi16(k.crv);
+    const __m256i cgu = _mm256_set1_epi16(k.cgu);
+    const __m256i cgv = _mm256_set1_epi16(k.cgv);
+    const __m256i cbu = _mm256_set1_epi16(k.cbu);
+    int x = x0;
+    for (; x + 16 <= x0 + w; x += 16) {
+        const __m256i yy = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)));
+        const __m128i uu8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + (x >> 1)));
+        const __m128i vv8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + (x >> 1)));
+        const __m256i uu = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(uu8, uu8)), c128);
+        const __m256i vv = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(vv8, vv8)), c128);
+        const __m256i c = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(yy, y0), cy), round);
+        const __m256i r = _mm256_srai_epi16(_mm256_adds_epi16(c, _mm256_mullo_epi16(vv, crv)), 6);
+        const __m256i g = _mm256_srai_epi16(_mm256_subs_epi16(_mm256_subs_epi16(c, _mm256_mullo_epi16(uu, cgu)), _mm256_mullo_epi16(vv, cgv)), 6);
+        const __m256i b = _mm256_srai_epi16(_mm256_adds_epi16(c, _mm256_mullo_epi16(uu, cbu)), 6);
+        // packing and unpacking work within 128 bit lanes: lane 0 holds pixels 0..7, lane 1 pixels 8..15
+        const __m256i bg = _mm256_unpacklo_epi8(_mm256_packus_epi16(b, b), _mm256_packus_epi16(g, g));
+        const __m256i ra = _mm256_unpacklo_epi8(_mm256_packus_epi16(r, r), alpha);
+        const __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+        const __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+        dst += 64;
+    }
+    convertRowScalar(y, u, v, x, x0 + w - x, dst, k);
+}
+
+
+static void cpuid(int leaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, 0);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, 0, a, b, c, d);
+    regs[0] = int(a);
+    regs[1] = int(b);
+    regs[2] = int(c);
+    regs[3] = int(d);
+#endif
+}
+
+
+static YUVConverter::Kernel detectKernel(void)
+{
+    int regs[4];
+    cpuid(0, regs);
+    const int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+        return YUVConverter::Scalar;
+    cpuid(1, regs);
+    const bool sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx) {
+        // the OS must save the YMM registers on context switches
+#if defined(_MSC_VER)
+        const unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+        const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+        cpuid(7, regs);
+        avx2 = (xcr0 & 6) == 6 && (regs[1] & (1 << 5)) != 0;
+    }
+    return avx2 ? YUVConverter::AVX2 : sse41 ? YUVConverter::SSE41 : YUVConverter::Scalar;
+}
+#else
+static YUVConverter::Kernel detectKernel(void)
+{
+    return YUVConverter::Scalar;
+}
+#endif
+
+
+static YUVConverter::Kernel supportedKernel = detectKernel();
+static YUVConverter::Kernel currentKernel = supportedKernel;
+
+
+static RowConverter rowConverter(void)
+{
+    switch (currentKernel) {
+#ifdef YUV_X86
+    case YUVConverter::AVX2:
+        return convertRowAVX2;
+    case YUVConverter::SSE41:
+        return convertRowSSE41;
+#endif
+    default:
+        return convertRowScalar;
+    }
+}
+
+
+YUVConverter::Kernel YUVConverter::kernel(void)
+{
+    return currentKernel;
+}
+
+
+// Selects a kernel, e.g. to compare them. Kernels the CPU doesn't support fall back to the best one it does.
+void YUVConverter::setKernel(Kernel kernel)
+{
+    currentKernel = qMin(kernel, supportedKernel);
+}
+
+
+const char *YUVConverter::kernelName(void)
+{
+    switch (currentKernel) {
+    case AVX2:
+        return "AVX2";
+    case SSE41:
+        return "SSE4.1";
+    default:
+        return "scalar";
+    }
+}
+
+
+// Converts the part of `frame` inside `rect`, which must lie within the
+// frame, to `dst`. The top left pixel of `rect` goes to `dst`.
+void YUVConverter::convert(const VideoFrame &frame, const QRect &rect, uchar *dst, int dstStride)
+{
+    Q_ASSERT(frame.pixelFormat() == VideoFrame::Format_YUV420P);
+    Q_ASSERT(QRect(QPoint(0, 0), frame.size()).contains(rect));
+    const RowConverter convertRow = rowConverter();
+    const Coefficients &k = coefficients[frame.colorMatrix][frame.colorRange];
+    for (int row = rect.top(); row <= rect.bottom(); ++row) {
+        convertRow(frame.bits(0) + row * frame.bytesPerLine(0),
+                   frame.bits(1) + (row >> 1) * frame.bytesPerLine(1),
+                   frame.bits(2) + (row >> 1) * frame.bytesPerLine(2),
+                   rect.left(), rect.width(), dst, k);
+        dst += dstStride;
+    }
+}
+
+
+// Returns `rect` of the frame, or all of it if `rect` is null, as an RGB32
+// image. Parts of `rect` outside the frame are black. RGB frames are
+// copied instead of converted.
+QImage YUVConverter::toImage(const VideoFrame &frame, const QRect &rect)
+{
+    const QRect frameRect(QPoint(0, 0), frame.size());
+    const QRect &area = rect.isNull() ? frameRect : rect;
+    if (frame.isRGB())
+        return frame.toImage().copy(area);
+    if (frame.pixelFormat() != VideoFrame::Format_YUV420P || area.isEmpty())
+        return QImage();
+    QImage image(area.size(), QImage::Format_RGB32);
+    const QRect &visible = area.intersected(frameRect);
+    if (visible != area)
+        image.fill(Qt::black);
+    if (!visible.isEmpty()) {
+        const QPoint &offset = visible.topLeft() - area.topLeft();
+        convert(frame, visible, image.scanLine(offset.y()) + 4 * offset.x(), image.bytesPerLine());
+    }
+    return image;
+}
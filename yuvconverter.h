@@ -0,0 +1,35 @@
+// Copyright (c) 2014 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __YUVCONVERTER_H_
+#define __YUVCONVERTER_H_
+
+#include <QImage>
+#include <QRect>
+
+#include "videoframe.h"
+
+
+// Converts planar YUV 4:2:0 to 32 bit BGRA as used by QImage::Format_RGB32,
+// honouring the frame's colour range and matrix the same way the shaders
+// do. Only the pixels inside the requested rectangle are touched. Picks an
+// AVX2, SSE4.1 or plain C++ kernel at runtime depending on what the CPU
+// supports.
+class YUVConverter
+{
+public:
+    enum Kernel {
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    static QImage toImage(const VideoFrame &frame, const QRect &rect = QRect());
+    static void convert(const VideoFrame &frame, const QRect &rect, uchar *dst, int dstStride);
+
+    static Kernel kernel(void);
+    static void setKernel(Kernel);
+    static const char *kernelName(void);
+};
+
+#endif // __YUVCONVERTER_H_